@@ -0,0 +1,218 @@
+#ifndef _ICY_BIT_PARALLEL_HPP_
+#define _ICY_BIT_PARALLEL_HPP_
+
+#include "pattern.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+#include <array>
+#include <bit>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace icy {
+
+namespace fsm {
+
+/**
+ * @brief 定长位向量
+ * @details 由 _W 个机器字组成，按字的循环可被编译器向量化
+ */
+template <size_t _W> struct bit_vector {
+    static constexpr size_t bits = 64 * _W;
+    constexpr void set(size_t _i) { _words[_i >> 6] |= std::uint64_t(1) << (_i & 63); }
+    constexpr bool test(size_t _i) const { return (_words[_i >> 6] >> (_i & 63)) & 1; }
+    constexpr bool any() const {
+        std::uint64_t _x = 0;
+        for (size_t _i = 0; _i != _W; ++_i) _x |= _words[_i];
+        return _x != 0;
+    }
+    /**
+     * @brief 第 _k 个字节
+     */
+    constexpr unsigned char byte(size_t _k) const {
+        return static_cast<unsigned char>(_words[_k >> 3] >> ((_k & 7) << 3));
+    }
+    constexpr bit_vector& operator|=(const bit_vector& _v) {
+        for (size_t _i = 0; _i != _W; ++_i) _words[_i] |= _v._words[_i];
+        return *this;
+    }
+    constexpr bit_vector& operator&=(const bit_vector& _v) {
+        for (size_t _i = 0; _i != _W; ++_i) _words[_i] &= _v._words[_i];
+        return *this;
+    }
+    friend constexpr bit_vector operator&(bit_vector _a, const bit_vector& _b) { return _a &= _b; }
+    friend constexpr bit_vector operator|(bit_vector _a, const bit_vector& _b) { return _a |= _b; }
+    friend constexpr bool operator==(const bit_vector&, const bit_vector&) = default;
+    std::array<std::uint64_t, _W> _words = {};
+};
+
+/**
+ * @brief 位并行模拟的非确定有限自动机
+ *
+ * @details 由 Thompson 自动机消去空边得到 Glushkov 自动机：每个位置（字节集合边）对应一位，另有一位表示初始状态。
+ * Glushkov 自动机进入同一位置的转移都带有相同的字节集合，因此活跃状态集合 D 的转移为
+ * <tt>D' = follow(D) & bytes[c]</tt>，其中 follow(D) 按 D 的每个字节查表后取并（Navarro-Raffinot），
+ * 可接受判断为一次掩码测试。状态数不随模式串的非确定性指数增长。
+ *
+ * 可同时运行多个模式串（至多 max_size 个），匹配结果与逐个调用 pattern::compile(_p).match 相同。
+ * @tparam _W 位向量的字数，状态数（位置数 + 1）不超过 64 * _W
+ */
+template <size_t _W = 1> class bit_nfa {
+    typedef bit_nfa self;
+public:
+    typedef bit_vector<_W> state_set;
+    static constexpr size_t max_size = 64;
+    /**
+     * @throw pattern::pattern_error 模式串语法错误，或状态数超过 64 * _W
+     */
+    explicit bit_nfa(std::string_view _p) : bit_nfa(std::vector<std::string_view>{_p}) {}
+    explicit bit_nfa(const std::vector<std::string_view>& _ps) {
+        assert(_ps.size() <= max_size);
+        _finals.resize(_ps.size());
+        _members.resize(_ps.size());
+        _entry.set(0);
+        std::vector<state_set> _follows(1); // position -> followers
+        for (size_t _j = 0; _j != _ps.size(); ++_j) {
+            _M_append(pattern::nfa(_ps[_j]), _j, _follows);
+        }
+        _chunks = (_positions + 7) / 8;
+        _follow.resize(_chunks * dfa::alphabet_size);
+        for (size_t _k = 0; _k != _chunks; ++_k) {
+            for (size_t _v = 1; _v != dfa::alphabet_size; ++_v) {
+                state_set& _f = _follow[_k * dfa::alphabet_size + _v];
+                for (size_t _b = 0; _b != 8; ++_b) {
+                    const size_t _p = _k * 8 + _b;
+                    if (((_v >> _b) & 1) && _p < _positions) _f |= _follows[_p];
+                }
+            }
+        }
+    }
+    bit_nfa(const self&) = default;
+    self& operator=(const self&) = default;
+    bit_nfa(self&&) = default;
+    self& operator=(self&&) = default;
+    ~bit_nfa() = default;
+public:
+    /**
+     * @brief 模式串数量
+     */
+    size_t size() const { return _finals.size(); }
+    /**
+     * @brief 状态数（位置数 + 1）
+     */
+    size_t states() const { return _positions; }
+    /**
+     * @brief 转移表占用的字节数
+     */
+    size_t table_bytes() const { return (_follow.size() + _bytes.size()) * sizeof(state_set); }
+    const state_set& entry() const { return _entry; }
+    /**
+     * @brief 活跃状态集合的转移，结果为空表示无法转移
+     */
+    state_set next(const state_set& _d, unsigned char _c) const {
+        state_set _n;
+        for (size_t _k = 0; _k != _chunks; ++_k) {
+            const unsigned char _v = _d.byte(_k);
+            if (_v != 0) _n |= _follow[_k * dfa::alphabet_size + _v];
+        }
+        return _n &= _bytes[_c];
+    }
+    /**
+     * @brief 是否有模式串可接受
+     */
+    bool acceptable(const state_set& _d) const { return (_d & _final).any(); }
+    /**
+     * @brief 第 _j 个模式串是否可接受
+     */
+    bool acceptable(const state_set& _d, size_t _j) const { return (_d & _finals[_j]).any(); }
+    /**
+     * @brief 单次遍历匹配
+     * @param _r 各模式串的匹配结果，大小不小于 size()
+     */
+    void match(std::string_view _s, std::span<dfa::result> _r) const {
+        assert(_r.size() >= size());
+        std::uint64_t _alive = (size() == max_size ? ~std::uint64_t(0) : (std::uint64_t(1) << size()) - 1);
+        for (size_t _j = 0; _j != size(); ++_j) {
+            _r[_j] = {false, _s.size()};
+        }
+        state_set _d = _entry;
+        size_t _i = 0;
+        for (; _i != _s.size() && _alive != 0; ++_i) {
+            const state_set _n = next(_d, static_cast<unsigned char>(_s[_i]));
+            if (size() == 1) {
+                if (!_n.any()) break;
+            }
+            else {
+                for (std::uint64_t _m = _alive; _m != 0; _m &= _m - 1) {
+                    const size_t _j = std::countr_zero(_m);
+                    if ((_n & _members[_j]).any()) continue;
+                    _alive &= ~(std::uint64_t(1) << _j);
+                    _r[_j] = {acceptable(_d, _j), _i};
+                }
+            }
+            _d = _n;
+        }
+        if (size() == 1 && _i != _s.size()) {
+            _r[0] = {acceptable(_d, 0), _i};
+            return;
+        }
+        for (std::uint64_t _m = _alive; _m != 0; _m &= _m - 1) {
+            const size_t _j = std::countr_zero(_m);
+            _r[_j].accepted = acceptable(_d, _j);
+        }
+    }
+    std::vector<dfa::result> match(std::string_view _s) const {
+        std::vector<dfa::result> _r(size());
+        match(_s, _r);
+        return _r;
+    }
+private:
+    /**
+     * @brief 消去空边，将模式串的位置追加到位向量中
+     */
+    void _M_append(const pattern::nfa& _n, size_t _j, std::vector<state_set>& _follows) {
+        std::vector<size_t> _bit(_n.size(), pattern::nfa::npos); // node -> position
+        for (size_t _s = 0; _s != _n.size(); ++_s) {
+            if (_n[_s]._next == pattern::nfa::npos) continue;
+            if (_positions == state_set::bits) {
+                throw pattern::pattern_error("too many positions in pattern for bit_nfa");
+            }
+            _bit[_s] = _positions++;
+            _follows.emplace_back();
+            for (size_t _c = 0; _c != dfa::alphabet_size; ++_c) {
+                if (_n[_s]._set.contains(static_cast<unsigned char>(_c))) _bytes[_c].set(_bit[_s]);
+            }
+            _members[_j].set(_bit[_s]);
+        }
+        auto _link = [&](size_t _from, size_t _node) {
+            std::vector<size_t> _c = {_node};
+            _n.closure(_c);
+            for (const size_t _t : _c) {
+                if (_t == _n.accept()) { _finals[_j].set(_from); _final.set(_from); }
+                if (_bit[_t] != pattern::nfa::npos) _follows[_from].set(_bit[_t]);
+            }
+        };
+        _link(0, _n.start());
+        for (size_t _s = 0; _s != _n.size(); ++_s) {
+            if (_bit[_s] != pattern::nfa::npos) _link(_bit[_s], _n[_s]._next);
+        }
+    }
+private:
+    size_t _positions = 1; // bit 0: entry
+    size_t _chunks = 0;
+    state_set _entry;
+    state_set _final; // accepting positions of any pattern
+    std::vector<state_set> _finals; // pattern -> accepting positions
+    std::vector<state_set> _members; // pattern -> positions
+    std::array<state_set, dfa::alphabet_size> _bytes = {}; // byte -> positions entered by the byte
+    std::vector<state_set> _follow; // (chunk, chunk value) -> followers
+};
+
+}
+
+}
+
+#endif // _ICY_BIT_PARALLEL_HPP_
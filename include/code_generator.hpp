@@ -0,0 +1,117 @@
+#ifndef _ICY_CODE_GENERATOR_HPP_
+#define _ICY_CODE_GENERATOR_HPP_
+
+#include "finite_automaton.hpp"
+
+#include <cctype>
+#include <cstddef>
+
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace icy {
+
+namespace fsm {
+
+/**
+ * @brief 将自动机生成为独立的 C++ 头文件
+ *
+ * @details 生成的头文件只依赖标准库，在命名空间 @c _name 中包含：
+ * 字节类表 @c classes 、可接受状态集合 @c accepting 、可接受且吸收的状态集合 @c absorbing 、
+ * 基于 switch 的转移函数 @c next 以及 @c match 。所有函数均为 constexpr，匹配语义（包括提前结束）与 dfa::match 一致。
+ * @param _name 命名空间名（须为合法标识符）
+ */
+inline void generate(std::ostream& _os, const dfa& _d, std::string_view _name) {
+    const size_t _n = _d.size();
+    const size_t _k = _d.classes();
+    std::string _guard = "_FSM_GENERATED_";
+    for (const char _c : _name) {
+        _guard.push_back(static_cast<char>(toupper(static_cast<unsigned char>(_c))));
+    }
+    _guard.append("_HPP_");
+    std::vector<unsigned char> _repr(_k); // one byte of each class
+    for (size_t _b = dfa::alphabet_size; _b-- != 0;) {
+        _repr[_d.classify(static_cast<unsigned char>(_b))] = static_cast<unsigned char>(_b);
+    }
+
+    _os << "// generated by finite_state_machine code generator, do not edit\n";
+    _os << "#ifndef " << _guard << "\n#define " << _guard << "\n\n";
+    _os << "#include <cstddef>\n\n#include <string_view>\n\n";
+    _os << "namespace " << _name << " {\n\n";
+    _os << "inline constexpr std::size_t states = " << _n << ";\n";
+    _os << "inline constexpr int entry = " << (_n == 0 ? -1 : static_cast<int>(_d.entry())) << ";\n";
+    _os << "inline constexpr unsigned char classes[256] = {";
+    for (size_t _b = 0; _b != dfa::alphabet_size; ++_b) {
+        _os << (_b % 16 == 0 ? "\n    " : " ") << static_cast<unsigned>(_d.classify(static_cast<unsigned char>(_b))) << ",";
+    }
+    _os << "\n};\n";
+    _os << "inline constexpr bool accepting[" << (_n == 0 ? 1 : _n) << "] = {";
+    for (size_t _s = 0; _s != _n; ++_s) {
+        _os << (_s % 16 == 0 ? "\n    " : " ") << (_d.acceptable(static_cast<dfa::state_id>(_s)) ? "true" : "false") << ",";
+    }
+    _os << (_n == 0 ? "false" : "") << "\n};\n";
+    _os << "inline constexpr bool absorbing[" << (_n == 0 ? 1 : _n) << "] = {";
+    for (size_t _s = 0; _s != _n; ++_s) {
+        _os << (_s % 16 == 0 ? "\n    " : " ") << (_d.absorbing(static_cast<dfa::state_id>(_s)) ? "true" : "false") << ",";
+    }
+    _os << (_n == 0 ? "false" : "") << "\n};\n\n";
+
+    _os << "struct result {\n    bool accepted;\n    std::size_t length;\n};\n\n";
+    _os << "/**\n * @return next state, or -1 if the byte can not be handled\n */\n";
+    _os << "constexpr int next(int _q, unsigned char _c) noexcept {\n";
+    _os << "    switch (_q) {\n";
+    for (size_t _s = 0; _s != _n; ++_s) {
+        if (_d.doomed(static_cast<dfa::state_id>(_s))) continue; // stop right after entering
+        _os << "    case " << _s << ":\n";
+        _os << "        switch (classes[_c]) {\n";
+        std::vector<bool> _done(_k);
+        for (size_t _c = 0; _c != _k; ++_c) {
+            const dfa::state_id _t = _d.next(static_cast<dfa::state_id>(_s), _repr[_c]);
+            if (_done[_c] || _t == dfa::npos) continue;
+            _os << "       ";
+            for (size_t _e = _c; _e != _k; ++_e) { // group classes with the same target
+                if (_d.next(static_cast<dfa::state_id>(_s), _repr[_e]) != _t) continue;
+                _done[_e] = true;
+                _os << " case " << _e << ":";
+            }
+            _os << " return " << _t << ";\n";
+        }
+        _os << "        default: return -1;\n";
+        _os << "        }\n";
+    }
+    _os << "    default: return -1;\n";
+    _os << "    }\n";
+    _os << "}\n\n";
+    _os << "/**\n * @brief handle bytes from the beginning, until the end of input or an unhandled byte\n */\n";
+    _os << "constexpr result match(std::string_view _s) noexcept {\n";
+    _os << "    if (entry < 0) return {false, 0};\n";
+    _os << "    int _q = entry;\n";
+    _os << "    std::size_t _i = 0;\n";
+    _os << "    for (; _i != _s.size(); ++_i) {\n";
+    _os << "        if (absorbing[_q]) return {true, _s.size()};\n";
+    _os << "        const int _n = next(_q, static_cast<unsigned char>(_s[_i]));\n";
+    _os << "        if (_n < 0) break;\n";
+    _os << "        _q = _n;\n";
+    _os << "    }\n";
+    _os << "    return {accepting[_q], _i};\n";
+    _os << "}\n\n";
+    _os << "}\n\n";
+    _os << "#endif // " << _guard << "\n";
+}
+
+/**
+ * @brief 将字符状态机编译、最小化后生成为独立的 C++ 头文件
+ */
+template <basic_state _Bs> void generate(std::ostream& _os, context<_Bs>& _f, std::string_view _name) {
+    dfa _d = dfa::compile(_f);
+    _d.minimize();
+    generate(_os, _d, _name);
+}
+
+}
+
+}
+
+#endif // _ICY_CODE_GENERATOR_HPP_
@@ -0,0 +1,203 @@
+#ifndef _ICY_DECIMAL_HPP_
+#define _ICY_DECIMAL_HPP_
+
+#include "static_automaton.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+#include <charconv>
+#include <limits>
+#include <string_view>
+#include <system_error>
+
+namespace icy {
+
+namespace fsm {
+
+/**
+ * @brief 十进制浮点数的累积器（字符状态机的动作库）
+ *
+ * @details 状态机每接受浮点数 <tt>[+-]?[0-9]+(\.[0-9]+)?(e[+-]?[0-9]+)?</tt> 的一个字节，调用一次 push，
+ * 在转移的同时累积符号、尾数（至多 max_digits 位有效数字）与十进制指数，不再重新扫描输入。
+ * 字节的合法性由状态机保证，push 不检查。
+ *
+ * value 在尾数与 10 的幂都能精确表示为 double 时用一次浮点乘除得到正确舍入的结果（Clinger 快速路径）；
+ * 否则对已接受的字节调用 std::from_chars（正确舍入，不分配内存）。
+ */
+class decimal {
+    typedef decimal self;
+public:
+    static constexpr size_t max_digits = 19;
+    constexpr decimal() = default;
+    constexpr void push(char _c) {
+        ++_length;
+        switch (_c) {
+            case '+': case '-':
+                if (_phase == phase::exponent) _exponent_negative = (_c == '-');
+                else _negative = (_c == '-');
+                return;
+            case '.': _phase = phase::fraction; return;
+            case 'e': case 'E': _phase = phase::exponent; return;
+            default: break;
+        }
+        const unsigned _d = static_cast<unsigned>(_c - '0');
+        if (_phase == phase::exponent) {
+            if (_exponent < exponent_limit) _exponent = _exponent * 10 + _d;
+            return;
+        }
+        if (_mantissa == 0 && _d == 0) { // leading zero
+            if (_phase == phase::fraction) --_scale;
+            return;
+        }
+        if (_digits != max_digits) {
+            _mantissa = _mantissa * 10 + _d;
+            ++_digits;
+            if (_phase == phase::fraction) --_scale;
+        }
+        else {
+            if (_phase == phase::integer) ++_scale;
+            _truncated = _truncated || _d != 0;
+        }
+    }
+    /**
+     * @brief 已累积的字节数
+     */
+    constexpr size_t length() const { return _length; }
+    constexpr bool negative() const { return _negative; }
+    /**
+     * @brief 尾数（有效数字）
+     */
+    constexpr std::uint64_t mantissa() const { return _mantissa; }
+    /**
+     * @brief 十进制指数：值为 mantissa() * 10^exponent()
+     */
+    constexpr std::int64_t exponent() const {
+        return _scale + (_exponent_negative ? -_exponent : _exponent);
+    }
+    /**
+     * @brief 尾数是否丢弃了非零的有效数字
+     */
+    constexpr bool truncated() const { return _truncated; }
+    /**
+     * @brief 正确舍入的值
+     * @param _s 累积的字节（至少包含前 length() 个字节），只在快速路径不适用时读取
+     */
+    double value(std::string_view _s) const {
+        double _v;
+        if (_M_fast(_v)) return _negative ? -_v : _v;
+        const char* _first = _s.data();
+        const char* const _last = _s.data() + _length;
+        if (_first != _last && *_first == '+') ++_first; // not accepted by from_chars
+        const std::from_chars_result _r = std::from_chars(_first, _last, _v);
+        if (_r.ec == std::errc::result_out_of_range) {
+            _v = (exponent() > 0 ? std::numeric_limits<double>::infinity() : 0.0);
+            return _negative ? -_v : _v;
+        }
+        return _v;
+    }
+    constexpr void clear() { *this = self(); }
+private:
+    enum class phase : std::uint8_t { integer, fraction, exponent };
+    static constexpr std::int64_t exponent_limit = 100000; // far beyond the range of double
+    static constexpr std::uint64_t exact_limit = std::uint64_t(1) << 53;
+    static constexpr double _S_powers[23] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    /**
+     * @brief Clinger 快速路径：尾数不超过 2^53 且 10 的幂可精确表示时，一次乘除即正确舍入
+     */
+    constexpr bool _M_fast(double& _v) const {
+        if (_truncated) return false;
+        if (_mantissa == 0) { _v = 0.0; return true; }
+        std::uint64_t _m = _mantissa;
+        std::int64_t _e = exponent();
+        if (_m > exact_limit || _e < -22) return false;
+        for (; _e > 22; --_e) { // move the excess of the power into the mantissa
+            if (_m > exact_limit / 10) return false;
+            _m *= 10;
+        }
+        _v = static_cast<double>(_m);
+        _v = (_e < 0 ? _v / _S_powers[-_e] : _v * _S_powers[_e]);
+        return true;
+    }
+private:
+    std::uint64_t _mantissa = 0;
+    std::int64_t _scale = 0; // decimal exponent contributed by dropped or fraction digits
+    std::int64_t _exponent = 0;
+    std::uint32_t _length = 0;
+    std::uint8_t _digits = 0;
+    phase _phase = phase::integer;
+    bool _negative = false;
+    bool _exponent_negative = false;
+    bool _truncated = false;
+};
+
+/**
+ * @brief 浮点数的语法
+ */
+struct float_syntax {
+    static constexpr std::string_view pattern = "[+-]?[0-9]+(\\.[0-9]+)?(e[+-]?[0-9]+)?";
+};
+
+/**
+ * @brief 浮点数的识别结果与值
+ */
+struct float_result {
+    bool accepted = false;
+    size_t length = 0;
+    double value = 0;
+};
+
+namespace {
+
+template <typename _Nf, typename _Af>
+float_result _S_parse_float(dfa::state_id _q, std::string_view _s, _Nf&& _next, _Af&& _accepting) {
+    float_result _r;
+    if (_q == dfa::npos) return _r;
+    decimal _d;
+    for (const char _c : _s) {
+        const dfa::state_id _n = _next(_q, _c);
+        if (_n == dfa::npos) break;
+        _d.push(_c);
+        _q = _n;
+    }
+    _r.length = _d.length();
+    _r.accepted = _accepting(_q);
+    if (_r.accepted) _r.value = _d.value(_s);
+    return _r;
+}
+
+}
+
+/**
+ * @brief 单次遍历识别浮点数并计算其值
+ * @details 由状态机编译得到的自动机（例如 dfa::compile 编译的浮点数识别状态机）驱动，识别语义与 dfa::match 一致；
+ * 每个字节查一次转移表并交给 decimal 累积，不可接受时值为 0
+ * @param _d 识别浮点数的自动机（接受的语言须为 float_syntax 的子集）
+ */
+inline float_result parse_float(const dfa& _d, std::string_view _s) {
+    return _S_parse_float(_d.entry(), _s,
+        [&_d](dfa::state_id _q, char _c) { return _d.next(_q, static_cast<unsigned char>(_c)); },
+        [&_d](dfa::state_id _q) { return _d.acceptable(_q); }
+    );
+}
+/**
+ * @brief 单次遍历识别浮点数并计算其值
+ * @details 同上，自动机由模式串在编译期编译（static_machine），不需要运行期构造状态机
+ * @tparam _Mt 浮点数的语法（须为 float_syntax 的子集）
+ */
+template <pattern_machine _Mt = float_syntax> float_result parse_float(std::string_view _s) {
+    const auto& _m = static_machine<_Mt>;
+    return _S_parse_float(_m.entry, _s,
+        [&_m](dfa::state_id _q, char _c) { return _m.table[_q * _m.classes + _m.classes_of[static_cast<unsigned char>(_c)]]; },
+        [&_m](dfa::state_id _q) { return _m.accepting[_q]; }
+    );
+}
+
+}
+
+}
+
+#endif // _ICY_DECIMAL_HPP_
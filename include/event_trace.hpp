@@ -0,0 +1,257 @@
+#ifndef _ICY_EVENT_TRACE_HPP_
+#define _ICY_EVENT_TRACE_HPP_
+
+#include "finite_state_machine.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <istream>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace icy {
+
+namespace fsm {
+
+/**
+ * @brief thrown by trace, to report malformed event trace
+ */
+class trace_error : public std::runtime_error {
+    using base = std::runtime_error;
+    using self = trace_error;
+public:
+    explicit trace_error() : base("") {}
+    explicit trace_error(const std::string& _arg) : base(_arg) {}
+    explicit trace_error(const char* _arg) : base(_arg) {}
+    trace_error(const self&) = default;
+    self& operator=(const self&) = default;
+    trace_error(self&&) = default;
+    self& operator=(self&&) = default;
+    virtual ~trace_error() override = default;
+};
+
+/**
+ * @brief 事件记录的二进制格式
+ * @details 文件头 "FSMT" 与版本号（1 字节）之后是若干条记录，整数均为小端序：
+ * - 'E' u16 编号, u16 长度, 事件类型名：定义事件类型（首次出现时写入）
+ * - 'S' u16 编号, u16 长度, 状态名：定义状态（首次出现时写入）
+ * - 'R' u16 事件类型, u8 大小, 事件对象的字节, u8 处理结果, u16 处理后的状态：一次事件处理
+ */
+struct trace_format {
+    static constexpr char magic[4] = {'F', 'S', 'M', 'T'};
+    static constexpr std::uint8_t version = 1;
+    static constexpr char event_type = 'E';
+    static constexpr char state_name = 'S';
+    static constexpr char record = 'R';
+};
+
+/**
+ * @brief 将 context::handle 处理的事件写为二进制记录
+ */
+class trace_writer : public tracer {
+    typedef trace_writer self;
+public:
+    explicit trace_writer(std::ostream& _os) : _os(_os) {
+        _os.write(trace_format::magic, sizeof(trace_format::magic));
+        _os.put(static_cast<char>(trace_format::version));
+    }
+    trace_writer(const self&) = delete;
+    self& operator=(const self&) = delete;
+    virtual ~trace_writer() override = default;
+public:
+    void record(const char* _name, const void* _data, size_t _size, bool _result, state::label_type _state) override {
+        const std::uint16_t _e = _M_define(_events, _name, trace_format::event_type);
+        const std::uint16_t _s = _M_define(_states, _state, trace_format::state_name);
+        _os.put(trace_format::record);
+        _M_put(_e);
+        _os.put(static_cast<char>(_size));
+        _os.write(static_cast<const char*>(_data), static_cast<std::streamsize>(_size));
+        _os.put(static_cast<char>(_result));
+        _M_put(_s);
+        ++_count;
+    }
+    /**
+     * @brief 已记录的事件数
+     */
+    size_t events() const { return _count; }
+private:
+    void _M_put(std::uint16_t _x) {
+        _os.put(static_cast<char>(_x & 0xff));
+        _os.put(static_cast<char>(_x >> 8));
+    }
+    std::uint16_t _M_define(std::unordered_map<std::string_view, std::uint16_t>& _ids, std::string_view _name, char _kind) {
+        const auto [_it, _new] = _ids.emplace(_name, static_cast<std::uint16_t>(_ids.size()));
+        if (_new) {
+            _os.put(_kind);
+            _M_put(_it->second);
+            _M_put(static_cast<std::uint16_t>(_name.size()));
+            _os.write(_name.data(), static_cast<std::streamsize>(_name.size()));
+        }
+        return _it->second;
+    }
+private:
+    std::ostream& _os;
+    std::unordered_map<std::string_view, std::uint16_t> _events;
+    std::unordered_map<std::string_view, std::uint16_t> _states;
+    size_t _count = 0;
+};
+
+/**
+ * @brief 读入内存的事件记录
+ */
+class trace {
+    typedef trace self;
+public:
+    struct entry {
+        std::uint16_t _event;
+        std::uint8_t _size;
+        bool _result;
+        std::uint16_t _state;
+        std::array<unsigned char, envelope::capacity> _data;
+    };
+    /**
+     * @throw trace_error 格式错误
+     */
+    explicit trace(std::istream& _is) {
+        char _head[sizeof(trace_format::magic) + 1];
+        if (!_is.read(_head, sizeof(_head)) || !std::equal(trace_format::magic, trace_format::magic + 4, _head)) {
+            throw trace_error("not an event trace");
+        }
+        if (static_cast<std::uint8_t>(_head[4]) != trace_format::version) {
+            throw trace_error("unsupported event trace version");
+        }
+        for (int _k; (_k = _is.get()) != std::istream::traits_type::eof();) {
+            switch (_k) {
+                case trace_format::event_type: _M_define(_is, _events); break;
+                case trace_format::state_name: _M_define(_is, _states); break;
+                case trace_format::record: {
+                    entry _e;
+                    _e._event = _M_get(_is);
+                    _e._size = static_cast<std::uint8_t>(_M_byte(_is));
+                    if (_e._event >= _events.size() || _e._size > envelope::capacity) {
+                        throw trace_error("malformed event record");
+                    }
+                    if (!_is.read(reinterpret_cast<char*>(_e._data.data()), _e._size)) {
+                        throw trace_error("truncated event trace");
+                    }
+                    _e._result = _M_byte(_is) != 0;
+                    _e._state = _M_get(_is);
+                    if (_e._state >= _states.size()) {
+                        throw trace_error("malformed event record");
+                    }
+                    _entries.push_back(_e);
+                    break;
+                }
+                default: throw trace_error("unknown record in event trace");
+            }
+        }
+    }
+    trace(const self&) = default;
+    self& operator=(const self&) = default;
+    ~trace() = default;
+public:
+    size_t size() const { return _entries.size(); }
+    const entry& operator[](size_t _i) const { return _entries[_i]; }
+    std::string_view event_name(const entry& _e) const { return _events[_e._event]; }
+    std::string_view state_name(const entry& _e) const { return _states[_e._state]; }
+private:
+    static unsigned char _M_byte(std::istream& _is) {
+        const int _c = _is.get();
+        if (_c == std::istream::traits_type::eof()) throw trace_error("truncated event trace");
+        return static_cast<unsigned char>(_c);
+    }
+    static std::uint16_t _M_get(std::istream& _is) {
+        const std::uint16_t _lo = _M_byte(_is);
+        return static_cast<std::uint16_t>(_lo | (_M_byte(_is) << 8));
+    }
+    static void _M_define(std::istream& _is, std::vector<std::string>& _names) {
+        const std::uint16_t _id = _M_get(_is);
+        std::string _name(_M_get(_is), '\0');
+        if (_id != _names.size() || !_is.read(_name.data(), static_cast<std::streamsize>(_name.size()))) {
+            throw trace_error("malformed definition in event trace");
+        }
+        _names.push_back(std::move(_name));
+    }
+private:
+    std::vector<std::string> _events;
+    std::vector<std::string> _states;
+    std::vector<entry> _entries;
+};
+
+/**
+ * @brief 回放报告
+ */
+struct replay_report {
+    size_t events = 0; // events handled, over all machines
+    size_t mismatches = 0; // results or states different from the trace
+    size_t first_mismatch = static_cast<size_t>(-1); // index in trace
+    double seconds = 0;
+    double events_per_second = 0;
+    std::chrono::nanoseconds p50{0};
+    std::chrono::nanoseconds p99{0};
+    std::chrono::nanoseconds p999{0};
+    std::chrono::nanoseconds max{0};
+};
+
+/**
+ * @brief 回放事件记录
+ * @details 事件依次交给每个状态机处理，并与记录中的处理结果、处理后的状态比较。
+ * 事件类型须已在 event_registry<_Bs> 中注册（按 typeid 名对应），未注册的事件被拒绝（处理结果为 false，状态不变）；
+ * 状态机应处于与记录开始时相同的状态。
+ */
+template <basic_state _Bs> replay_report replay(const trace& _t, std::span<context<_Bs>* const> _fs) {
+    typedef std::chrono::steady_clock clock;
+    std::vector<envelope> _queue;
+    _queue.reserve(_t.size());
+    for (size_t _i = 0; _i != _t.size(); ++_i) {
+        const auto& _e = _t[_i];
+        _queue.emplace_back(event_registry<_Bs>::find(_t.event_name(_e)), _e._data.data(), _e._size);
+    }
+    replay_report _r;
+    std::vector<clock::duration> _latency;
+    _latency.reserve(_t.size() * _fs.size());
+    const clock::time_point _begin = clock::now();
+    for (size_t _i = 0; _i != _t.size(); ++_i) {
+        for (context<_Bs>* const _f : _fs) {
+            const clock::time_point _a = clock::now();
+            const bool _result = _f->handle(_queue[_i]);
+            _latency.push_back(clock::now() - _a);
+            if (_result != _t[_i]._result || _f->label() != _t.state_name(_t[_i])) {
+                if (_r.mismatches++ == 0) _r.first_mismatch = _i;
+            }
+        }
+    }
+    _r.seconds = std::chrono::duration<double>(clock::now() - _begin).count();
+    _r.events = _latency.size();
+    if (_r.events == 0) return _r;
+    _r.events_per_second = _r.seconds > 0 ? _r.events / _r.seconds : 0;
+    auto _percentile = [&](double _p) {
+        const auto _it = _latency.begin() + static_cast<std::ptrdiff_t>(_p * (_latency.size() - 1));
+        std::nth_element(_latency.begin(), _it, _latency.end());
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(*_it);
+    };
+    _r.p50 = _percentile(0.5);
+    _r.p99 = _percentile(0.99);
+    _r.p999 = _percentile(0.999);
+    _r.max = std::chrono::duration_cast<std::chrono::nanoseconds>(*std::max_element(_latency.begin(), _latency.end()));
+    return _r;
+}
+template <basic_state _Bs> replay_report replay(const trace& _t, context<_Bs>& _f) {
+    context<_Bs>* const _p = &_f;
+    return replay<_Bs>(_t, std::span<context<_Bs>* const>(&_p, 1));
+}
+
+}
+
+}
+
+#endif // _ICY_EVENT_TRACE_HPP_
@@ -0,0 +1,734 @@
+#ifndef _ICY_FINITE_AUTOMATON_HPP_
+#define _ICY_FINITE_AUTOMATON_HPP_
+
+#include "finite_state_machine.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <limits>
+#include <map>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace icy {
+
+namespace fsm {
+
+/**
+ * @brief 表驱动的确定有限自动机
+ *
+ * @details 字符状态机的编译产物：字节先经过字节类（byte class）映射，再查 状态 x 字节类 的转移表。
+ * 转移表中的 @c npos 表示该输入无法被处理（等价于 state::handle 返回非法标识）。
+ */
+class dfa {
+    typedef dfa self;
+public:
+    typedef std::uint16_t state_id;
+    typedef std::uint8_t class_id;
+    static constexpr state_id npos = std::numeric_limits<state_id>::max();
+    static constexpr size_t alphabet_size = 256;
+    /**
+     * @brief 匹配结果
+     * @details @c length 为状态机停止前成功处理的字节数
+     */
+    struct result {
+        bool accepted = false;
+        size_t length = 0;
+    };
+    /**
+     * @brief 编译报告（状态数、字节类数与表大小）
+     */
+    struct report {
+        size_t states_before = 0;
+        size_t states_after = 0;
+        size_t classes_before = 0;
+        size_t classes_after = 0;
+        size_t table_bytes_before = 0;
+        size_t table_bytes_after = 0;
+    };
+    constexpr dfa() {
+        for (size_t _b = 0; _b != alphabet_size; ++_b) {
+            _classes[_b] = static_cast<class_id>(_b);
+        }
+    }
+    dfa(const self&) = default;
+    self& operator=(const self&) = default;
+    dfa(self&&) = default;
+    self& operator=(self&&) = default;
+    ~dfa() = default;
+public:
+    /**
+     * @brief 新增状态
+     * @return 新状态的编号
+     */
+    constexpr state_id add_state(bool _accepting = false) {
+        _M_expand();
+        _fate.clear();
+        assert(_accept.size() < npos);
+        _table.insert(_table.end(), _class_count, npos);
+        _accept.push_back(_accepting);
+        if (_entry == npos) _entry = 0;
+        return static_cast<state_id>(_accept.size() - 1);
+    }
+    /**
+     * @brief 新增转移
+     */
+    constexpr void link(state_id _from, unsigned char _c, state_id _to) {
+        _M_expand();
+        _fate.clear();
+        _table[_from * _class_count + _c] = _to;
+    }
+    /**
+     * @brief 设置状态是否可接受
+     */
+    constexpr void accept(state_id _s, bool _accepting = true) {
+        _fate.clear();
+        _accept[_s] = _accepting;
+    }
+    /**
+     * @brief 设置初始状态
+     */
+    constexpr void entry(state_id _s) { _entry = _s; }
+    constexpr state_id entry() const { return _entry; }
+    /**
+     * @brief 状态数
+     */
+    constexpr size_t size() const { return _accept.size(); }
+    /**
+     * @brief 字节类数
+     */
+    constexpr size_t classes() const { return _class_count; }
+    constexpr class_id classify(unsigned char _c) const { return _classes[_c]; }
+    /**
+     * @brief 转移表占用的字节数（含字节类映射与可接受标记）
+     */
+    constexpr size_t table_bytes() const {
+        return _table.size() * sizeof(state_id) + sizeof(_classes) + _accept.size();
+    }
+    constexpr bool acceptable(state_id _s) const {
+        return _s != npos && _accept[_s];
+    }
+    constexpr state_id next(state_id _s, unsigned char _c) const {
+        return _table[_s * _class_count + _classes[_c]];
+    }
+    /**
+     * @brief 状态的结局
+     * @details 由 analyze 计算（minimize 会调用 analyze），修改自动机后失效，此时所有状态均视为 @c open
+     */
+    enum class fate : std::uint8_t {
+        open,
+        doomed, // 无法再到达可接受状态
+        absorbing, // 可接受，且任意输入都转移到同类状态
+    };
+    constexpr fate fate_of(state_id _s) const {
+        return (_fate.empty() || _s == npos ? fate::open : _fate[_s]);
+    }
+    constexpr bool doomed(state_id _s) const { return fate_of(_s) == fate::doomed; }
+    constexpr bool absorbing(state_id _s) const { return fate_of(_s) == fate::absorbing; }
+    /**
+     * @brief 计算各状态的结局
+     */
+    constexpr void analyze() {
+        const size_t _n = size(), _k = _class_count;
+        std::vector<std::vector<state_id>> _reverse(_n);
+        for (size_t _s = 0; _s != _n; ++_s) {
+            for (size_t _c = 0; _c != _k; ++_c) {
+                const state_id _t = _table[_s * _k + _c];
+                if (_t != npos) _reverse[_t].push_back(static_cast<state_id>(_s));
+            }
+        }
+        std::vector<std::uint8_t> _live(_accept); // can reach an accepting state
+        std::vector<state_id> _stack;
+        for (size_t _s = 0; _s != _n; ++_s) {
+            if (_live[_s]) _stack.push_back(static_cast<state_id>(_s));
+        }
+        while (!_stack.empty()) {
+            const state_id _s = _stack.back();
+            _stack.pop_back();
+            for (const state_id _p : _reverse[_s]) {
+                if (!_live[_p]) { _live[_p] = true; _stack.push_back(_p); }
+            }
+        }
+        std::vector<std::uint8_t> _closed(_accept); // greatest accepting set closed under all transitions
+        for (bool _changed = true; _changed;) {
+            _changed = false;
+            for (size_t _s = 0; _s != _n; ++_s) {
+                if (!_closed[_s]) continue;
+                for (size_t _c = 0; _c != _k; ++_c) {
+                    const state_id _t = _table[_s * _k + _c];
+                    if (_t == npos || !_closed[_t]) { _closed[_s] = false; _changed = true; break; }
+                }
+            }
+        }
+        _fate.assign(_n, fate::open);
+        for (size_t _s = 0; _s != _n; ++_s) {
+            if (!_live[_s]) _fate[_s] = fate::doomed;
+            else if (_closed[_s]) _fate[_s] = fate::absorbing;
+        }
+    }
+    /**
+     * @brief 从初始状态开始处理字符串，直到输入结束或无法转移
+     * @details 已分析（analyze）的自动机进入 @c doomed 状态后立即停止（结果不可接受，长度为已处理的字节数）；
+     * 进入 @c absorbing 状态后结果已确定（可接受，长度为输入长度），不再处理剩余输入
+     */
+    constexpr result match(std::string_view _s) const {
+        if (_entry == npos) return {};
+        state_id _q = _entry;
+        size_t _i = 0;
+        for (; _i != _s.size(); ++_i) {
+            if (fate_of(_q) != fate::open) [[unlikely]] break;
+            const state_id _n = next(_q, static_cast<unsigned char>(_s[_i]));
+            if (_n == npos) break;
+            _q = _n;
+        }
+        if (absorbing(_q)) return {true, _s.size()};
+        return {acceptable(_q), _i};
+    }
+    /**
+     * @brief 批量匹配多个相互独立的（短）字符串
+     * @details 结果与逐个调用 match 相同。转移表只在批量开始时改写一次：无法转移改为进入一个吸收状态，
+     * 因此逐字节的循环中没有分支，每 @c batch_block 个字节才判断一次是否已无法转移。
+     * @c doomed 状态的所有转移同样改为进入吸收状态；进入 @c absorbing 状态后不再处理剩余输入。
+     * @param _r 各字符串的匹配结果，大小不小于 _ss.size()
+     */
+    void match(std::span<const std::string_view> _ss, std::span<result> _r) const {
+        assert(_r.size() >= _ss.size());
+        if (_entry == npos) {
+            std::fill_n(_r.begin(), _ss.size(), result());
+            return;
+        }
+        const state_id _sink = static_cast<state_id>(size());
+        std::vector<state_id> _t(_table.size() + _class_count, _sink);
+        for (size_t _i = 0; _i != _table.size(); ++_i) {
+            if (_table[_i] != npos && !doomed(static_cast<state_id>(_i / _class_count))) _t[_i] = _table[_i];
+        }
+        for (size_t _j = 0; _j != _ss.size(); ++_j) {
+            state_id _q = _entry, _live = _entry; // _live: last state other than _sink
+            size_t _length = 0;
+            const std::string_view _s = _ss[_j];
+            for (size_t _i = 0; _i < _s.size() && _q != _sink; _i += batch_block) {
+                if (absorbing(_q)) [[unlikely]] {
+                    _length = _s.size();
+                    break;
+                }
+                for (const char _c : _s.substr(_i, batch_block)) {
+                    _q = _t[_q * _class_count + _classes[static_cast<unsigned char>(_c)]];
+                    const bool _alive = _q != _sink;
+                    _live = (_alive ? _q : _live);
+                    _length += _alive;
+                }
+            }
+            _r[_j] = {acceptable(_live), _length};
+        }
+    }
+    std::vector<result> match(std::span<const std::string_view> _ss) const {
+        std::vector<result> _r(_ss.size());
+        match(_ss, _r);
+        return _r;
+    }
+    static constexpr size_t batch_block = 16;
+    /**
+     * @brief 最小化
+     * @details 依次进行：不可达状态剪枝、字节类压缩、Hopcroft 最小化、字节类压缩。
+     * 无法转移（@c npos）被视为独立于所有状态的死状态参与划分，因此最小化前后的接受结果与匹配长度一致。
+     */
+    constexpr report minimize() {
+        report _r;
+        _r.states_before = size();
+        _r.classes_before = _class_count;
+        _r.table_bytes_before = table_bytes();
+        _M_prune();
+        _M_compress();
+        _M_hopcroft();
+        _M_compress();
+        analyze();
+        _r.states_after = size();
+        _r.classes_after = _class_count;
+        _r.table_bytes_after = table_bytes();
+        return _r;
+    }
+    /**
+     * @brief 从字符状态机编译得到自动机
+     * @details 自默认初始状态起，对每个可达状态探测全部 256 个字节经 character::handle 后的转移结果。
+     * 要求状态转移仅取决于 (状态, 字节)，探测过程中会重置状态机。
+     */
+    template <basic_state _Bs> static self compile(context<_Bs>& _f);
+private:
+    /**
+     * @brief 撤销字节类压缩，恢复为 256 列的转移表
+     */
+    constexpr void _M_expand() {
+        if (_class_count == alphabet_size) return;
+        std::vector<state_id> _t(size() * alphabet_size);
+        for (size_t _s = 0; _s != size(); ++_s) {
+            for (size_t _b = 0; _b != alphabet_size; ++_b) {
+                _t[_s * alphabet_size + _b] = _table[_s * _class_count + _classes[_b]];
+            }
+        }
+        _table = std::move(_t);
+        _class_count = alphabet_size;
+        for (size_t _b = 0; _b != alphabet_size; ++_b) {
+            _classes[_b] = static_cast<class_id>(_b);
+        }
+    }
+    /**
+     * @brief 按 _order 中的顺序重新编号状态，未出现的状态被删除
+     * @param _order 新编号 -> 旧编号
+     */
+    constexpr void _M_renumber(const std::vector<state_id>& _order) {
+        std::vector<state_id> _map(size(), npos);
+        for (size_t _i = 0; _i != _order.size(); ++_i) {
+            _map[_order[_i]] = static_cast<state_id>(_i);
+        }
+        std::vector<state_id> _t(_order.size() * _class_count);
+        std::vector<std::uint8_t> _a(_order.size());
+        for (size_t _i = 0; _i != _order.size(); ++_i) {
+            for (size_t _c = 0; _c != _class_count; ++_c) {
+                const state_id _n = _table[_order[_i] * _class_count + _c];
+                _t[_i * _class_count + _c] = (_n == npos ? npos : _map[_n]);
+            }
+            _a[_i] = _accept[_order[_i]];
+        }
+        _table = std::move(_t);
+        _accept = std::move(_a);
+        _entry = (_entry == npos ? npos : _map[_entry]);
+    }
+    /**
+     * @brief 删除不可达状态，并按广度优先顺序重新编号
+     */
+    constexpr void _M_prune() {
+        std::vector<state_id> _order;
+        if (_entry == npos) { _M_renumber(_order); return; }
+        std::vector<std::uint8_t> _seen(size());
+        _order.push_back(_entry);
+        _seen[_entry] = true;
+        for (size_t _i = 0; _i != _order.size(); ++_i) {
+            for (size_t _c = 0; _c != _class_count; ++_c) {
+                const state_id _n = _table[_order[_i] * _class_count + _c];
+                if (_n != npos && !_seen[_n]) {
+                    _seen[_n] = true;
+                    _order.push_back(_n);
+                }
+            }
+        }
+        _M_renumber(_order);
+    }
+    /**
+     * @brief 字节类压缩：转移表中列完全相同的字节合并为同一字节类
+     */
+    constexpr void _M_compress() {
+        _M_expand();
+        std::array<size_t, alphabet_size> _cls = {};
+        std::array<std::pair<std::pair<size_t, state_id>, size_t>, alphabet_size> _keys;
+        for (size_t _s = 0; _s != size(); ++_s) { // refine by each row
+            for (size_t _b = 0; _b != alphabet_size; ++_b) {
+                _keys[_b] = {{_cls[_b], _table[_s * alphabet_size + _b]}, _b};
+            }
+            std::sort(_keys.begin(), _keys.end());
+            size_t _count = 0;
+            for (size_t _i = 0; _i != alphabet_size; ++_i) {
+                if (_i != 0 && _keys[_i].first != _keys[_i - 1].first) ++_count;
+                _cls[_keys[_i].second] = _count;
+            }
+        }
+        // number classes by first byte, so that the mapping is stable
+        std::array<size_t, alphabet_size> _rename;
+        _rename.fill(alphabet_size);
+        size_t _next = 0;
+        std::array<size_t, alphabet_size> _repr = {};
+        for (size_t _b = 0; _b != alphabet_size; ++_b) {
+            if (_rename[_cls[_b]] == alphabet_size) {
+                _repr[_next] = _b;
+                _rename[_cls[_b]] = _next++;
+            }
+            _classes[_b] = static_cast<class_id>(_rename[_cls[_b]]);
+        }
+        std::vector<state_id> _t(size() * _next);
+        for (size_t _s = 0; _s != size(); ++_s) {
+            for (size_t _c = 0; _c != _next; ++_c) {
+                _t[_s * _next + _c] = _table[_s * alphabet_size + _repr[_c]];
+            }
+        }
+        _table = std::move(_t);
+        _class_count = _next;
+    }
+    /**
+     * @brief Hopcroft 最小化
+     * @details 状态 size() 为死状态（npos），与其余状态分属不同的初始块
+     */
+    constexpr void _M_hopcroft() {
+        const size_t _n = size() + 1;
+        const size_t _dead = size();
+        const size_t _k = _class_count;
+        if (_n == 1) return;
+        auto _delta = [&](size_t _s, size_t _c) -> size_t {
+            if (_s == _dead) return _dead;
+            const state_id _t = _table[_s * _k + _c];
+            return (_t == npos ? _dead : _t);
+        };
+        // inverse transitions in CSR form, indexed by (class, target)
+        std::vector<size_t> _inv_off(_k * _n + 1);
+        std::vector<size_t> _inv(_k * _n);
+        for (size_t _c = 0; _c != _k; ++_c) {
+            for (size_t _s = 0; _s != _n; ++_s) {
+                ++_inv_off[_c * _n + _delta(_s, _c) + 1];
+            }
+        }
+        for (size_t _i = 1; _i != _inv_off.size(); ++_i) {
+            _inv_off[_i] += _inv_off[_i - 1];
+        }
+        {
+            std::vector<size_t> _fill(_inv_off.begin(), _inv_off.end() - 1);
+            for (size_t _c = 0; _c != _k; ++_c) {
+                for (size_t _s = 0; _s != _n; ++_s) {
+                    _inv[_fill[_c * _n + _delta(_s, _c)]++] = _s;
+                }
+            }
+        }
+        // partition: block _b owns _elems[_first[_b], _past[_b]), marked ones at the front
+        std::vector<size_t> _elems(_n), _loc(_n), _blk(_n);
+        std::vector<size_t> _first, _past, _marked;
+        auto _new_block = [&](auto _pred) {
+            const size_t _b = _first.size();
+            const size_t _begin = (_b == 0 ? 0 : _past.back());
+            size_t _end = _begin;
+            for (size_t _s = 0; _s != _n; ++_s) {
+                if (!_pred(_s)) continue;
+                _elems[_end] = _s; _loc[_s] = _end; _blk[_s] = _b; ++_end;
+            }
+            if (_end == _begin) return;
+            _first.push_back(_begin); _past.push_back(_end); _marked.push_back(0);
+        };
+        _new_block([&](size_t _s) { return _s == _dead; });
+        _new_block([&](size_t _s) { return _s != _dead && _accept[_s]; });
+        _new_block([&](size_t _s) { return _s != _dead && !_accept[_s]; });
+        std::vector<std::uint8_t> _waiting(_n * _k);
+        std::vector<std::pair<size_t, size_t>> _work;
+        for (size_t _b = 0; _b != _first.size(); ++_b) {
+            for (size_t _c = 0; _c != _k; ++_c) {
+                _work.emplace_back(_b, _c);
+                _waiting[_b * _k + _c] = true;
+            }
+        }
+        std::vector<size_t> _touched;
+        std::vector<size_t> _splitter;
+        while (!_work.empty()) {
+            const auto [_a, _c] = _work.back();
+            _work.pop_back();
+            _waiting[_a * _k + _c] = false;
+            _splitter.assign(_elems.begin() + _first[_a], _elems.begin() + _past[_a]);
+            for (const size_t _t : _splitter) {
+                for (size_t _i = _inv_off[_c * _n + _t]; _i != _inv_off[_c * _n + _t + 1]; ++_i) {
+                    const size_t _s = _inv[_i];
+                    const size_t _b = _blk[_s];
+                    const size_t _j = _first[_b] + _marked[_b];
+                    if (_loc[_s] < _j) continue; // already marked
+                    const size_t _o = _elems[_j];
+                    std::swap(_elems[_loc[_s]], _elems[_j]);
+                    _loc[_o] = _loc[_s]; _loc[_s] = _j;
+                    if (_marked[_b]++ == 0) _touched.push_back(_b);
+                }
+            }
+            for (const size_t _b : _touched) {
+                const size_t _m = _marked[_b];
+                _marked[_b] = 0;
+                if (_m == _past[_b] - _first[_b]) continue;
+                const size_t _nb = _first.size();
+                _first.push_back(_first[_b]);
+                _past.push_back(_first[_b] + _m);
+                _marked.push_back(0);
+                _first[_b] += _m;
+                for (size_t _i = _first[_nb]; _i != _past[_nb]; ++_i) {
+                    _blk[_elems[_i]] = _nb;
+                }
+                const bool _smaller = (_m <= _past[_b] - _first[_b]);
+                for (size_t _d = 0; _d != _k; ++_d) {
+                    const size_t _add = (_waiting[_b * _k + _d] || _smaller ? _nb : _b);
+                    if (_waiting[_add * _k + _d]) continue;
+                    _waiting[_add * _k + _d] = true;
+                    _work.emplace_back(_add, _d);
+                }
+            }
+            _touched.clear();
+        }
+        // rebuild: one state per block (except the dead block), numbered by first member
+        const size_t _dead_block = _blk[_dead];
+        std::vector<state_id> _id(_first.size(), npos);
+        std::vector<size_t> _repr;
+        for (size_t _s = 0; _s != _dead; ++_s) {
+            const size_t _b = _blk[_s];
+            if (_b == _dead_block || _id[_b] != npos) continue;
+            _id[_b] = static_cast<state_id>(_repr.size());
+            _repr.push_back(_s);
+        }
+        std::vector<state_id> _t(_repr.size() * _k);
+        std::vector<std::uint8_t> _acc(_repr.size());
+        for (size_t _i = 0; _i != _repr.size(); ++_i) {
+            for (size_t _c = 0; _c != _k; ++_c) {
+                _t[_i * _k + _c] = _id[_blk[_delta(_repr[_i], _c)]];
+            }
+            _acc[_i] = _accept[_repr[_i]];
+        }
+        _entry = (_entry == npos ? npos : _id[_blk[_entry]]);
+        _table = std::move(_t);
+        _accept = std::move(_acc);
+    }
+private:
+    std::array<class_id, alphabet_size> _classes = {};
+    size_t _class_count = alphabet_size;
+    std::vector<state_id> _table;
+    std::vector<std::uint8_t> _accept;
+    state_id _entry = npos;
+    std::vector<fate> _fate; // empty if not analyzed
+    friend class dfa_set;
+};
+
+/**
+ * @brief 在同一次遍历中运行多个自动机
+ *
+ * @details 每个字节只分类一次（各自动机字节类的公共细分），随后推进所有自动机。
+ * 乘积自动机的状态数不超过 @c product_limit 时，构造单个乘积自动机，每个字节只查一次表；
+ * 否则退化为并行运行的自动机组。两种方式的结果均与逐个调用 dfa::match 相同。
+ */
+class dfa_set {
+    typedef dfa_set self;
+    typedef std::uint64_t mask_type;
+public:
+    typedef dfa::state_id state_id;
+    static constexpr size_t max_size = 64;
+    static constexpr size_t default_product_limit = 4096;
+    explicit dfa_set(std::vector<dfa> _machines, size_t _product_limit = default_product_limit)
+    : _machines(std::move(_machines)) {
+        assert(this->_machines.size() <= max_size);
+        _M_classify();
+        _product = _M_product(_product_limit);
+    }
+    dfa_set(const self&) = default;
+    self& operator=(const self&) = default;
+    dfa_set(self&&) = default;
+    self& operator=(self&&) = default;
+    ~dfa_set() = default;
+public:
+    /**
+     * @brief 自动机数量
+     */
+    size_t size() const { return _machines.size(); }
+    /**
+     * @brief 是否以乘积自动机的方式运行
+     */
+    bool is_product() const { return _product; }
+    /**
+     * @brief 乘积自动机的状态数（自动机组方式下为 0）
+     */
+    size_t product_states() const { return _alive.size(); }
+    /**
+     * @brief 公共字节类数
+     */
+    size_t classes() const { return _class_count; }
+    /**
+     * @brief 单次遍历匹配
+     * @param _r 各自动机的匹配结果，大小不小于 size()
+     */
+    void match(std::string_view _s, std::span<dfa::result> _r) const {
+        assert(_r.size() >= size());
+        if (_product) _M_match_product(_s, _r);
+        else _M_match_bank(_s, _r);
+    }
+    std::vector<dfa::result> match(std::string_view _s) const {
+        std::vector<dfa::result> _r(size());
+        match(_s, _r);
+        return _r;
+    }
+private:
+    /**
+     * @brief 计算公共字节类，以及公共字节类到各自动机字节类的映射
+     */
+    void _M_classify() {
+        std::map<std::vector<dfa::class_id>, size_t> _ids;
+        std::vector<std::vector<dfa::class_id>> _keys;
+        for (size_t _b = 0; _b != dfa::alphabet_size; ++_b) {
+            std::vector<dfa::class_id> _k(size());
+            for (size_t _j = 0; _j != size(); ++_j) {
+                _k[_j] = (_machines[_j]._entry == dfa::npos ? 0 : _machines[_j]._classes[_b]);
+            }
+            const auto [_it, _new] = _ids.emplace(_k, _ids.size());
+            if (_new) _keys.push_back(_k);
+            _classes[_b] = static_cast<dfa::class_id>(_it->second);
+        }
+        _class_count = _keys.size();
+        _local.resize(size() * _class_count);
+        for (size_t _c = 0; _c != _class_count; ++_c) {
+            for (size_t _j = 0; _j != size(); ++_j) {
+                _local[_j * _class_count + _c] = _keys[_c][_j];
+            }
+        }
+    }
+    /**
+     * @brief 构造乘积自动机
+     * @return 乘积自动机的状态数是否在限制内
+     */
+    bool _M_product(size_t _limit) {
+        _limit = std::min<size_t>(_limit, dfa::npos);
+        std::map<std::vector<state_id>, state_id> _ids;
+        std::vector<std::vector<state_id>> _tuples;
+        auto _id_of = [&](const std::vector<state_id>& _t) -> state_id {
+            const auto [_it, _new] = _ids.emplace(_t, static_cast<state_id>(_tuples.size()));
+            if (_new) _tuples.push_back(_t);
+            return _it->second;
+        };
+        std::vector<state_id> _t(size());
+        for (size_t _j = 0; _j != size(); ++_j) {
+            _t[_j] = _machines[_j]._entry;
+        }
+        _id_of(_t);
+        for (size_t _i = 0; _i != _tuples.size(); ++_i) {
+            if (_tuples.size() > _limit) {
+                _table.clear(); _alive.clear(); _accept.clear(); _settled.clear();
+                return false;
+            }
+            mask_type _alive_mask = 0, _accept_mask = 0, _absorbing_mask = 0;
+            for (size_t _j = 0; _j != size(); ++_j) {
+                const state_id _q = _tuples[_i][_j];
+                if (_q == dfa::npos) continue;
+                _alive_mask |= mask_type(1) << _j;
+                if (_machines[_j].acceptable(_q)) _accept_mask |= mask_type(1) << _j;
+                if (_machines[_j].absorbing(_q)) _absorbing_mask |= mask_type(1) << _j;
+            }
+            _alive.push_back(_alive_mask);
+            _accept.push_back(_accept_mask);
+            _settled.push_back(_alive_mask == _absorbing_mask);
+            for (size_t _c = 0; _c != _class_count; ++_c) {
+                bool _any = false;
+                for (size_t _j = 0; _j != size(); ++_j) {
+                    const state_id _q = _tuples[_i][_j];
+                    _t[_j] = (_q == dfa::npos ? dfa::npos : _M_next(_j, _q, _c));
+                    _any = _any || _t[_j] != dfa::npos;
+                }
+                _table.push_back(_any ? _id_of(_t) : dfa::npos);
+            }
+        }
+        return true;
+    }
+    /**
+     * @brief 第 _j 个自动机的转移，@c doomed 状态视为无法转移
+     */
+    state_id _M_next(size_t _j, state_id _q, size_t _c) const {
+        const dfa& _m = _machines[_j];
+        if (_m.doomed(_q)) return dfa::npos;
+        return _m._table[_q * _m._class_count + _local[_j * _class_count + _c]];
+    }
+    void _M_match_product(std::string_view _s, std::span<dfa::result> _r) const {
+        if (_alive.empty()) return;
+        for (size_t _j = 0; _j != size(); ++_j) {
+            _r[_j] = {false, ((_alive[0] >> _j) & 1) ? _s.size() : 0};
+        }
+        state_id _q = 0;
+        mask_type _accepted = 0;
+        size_t _i = 0;
+        for (; _i != _s.size(); ++_i) {
+            if (_settled[_q]) [[unlikely]] break;
+            const state_id _n = _table[_q * _class_count + _classes[static_cast<unsigned char>(_s[_i])]];
+            const mask_type _died = _alive[_q] & (_n == dfa::npos ? ~mask_type(0) : ~_alive[_n]);
+            if (_died != 0) {
+                _accepted |= _accept[_q] & _died;
+                for (mask_type _m = _died; _m != 0; _m &= _m - 1) {
+                    _r[std::countr_zero(_m)].length = _i;
+                }
+            }
+            if (_n == dfa::npos) break;
+            _q = _n;
+        }
+        if (_i == _s.size() || _settled[_q]) {
+            _accepted |= _accept[_q];
+        }
+        for (size_t _j = 0; _j != size(); ++_j) {
+            _r[_j].accepted = (_accepted >> _j) & 1;
+        }
+    }
+    void _M_match_bank(std::string_view _s, std::span<dfa::result> _r) const {
+        std::array<state_id, max_size> _q;
+        mask_type _alive_mask = 0;
+        for (size_t _j = 0; _j != size(); ++_j) {
+            _q[_j] = _machines[_j]._entry;
+            _r[_j] = {false, _s.size()};
+            if (_q[_j] != dfa::npos) _alive_mask |= mask_type(1) << _j;
+            else _r[_j].length = 0;
+        }
+        for (size_t _i = 0; _i != _s.size() && _alive_mask != 0; ++_i) {
+            const size_t _c = _classes[static_cast<unsigned char>(_s[_i])];
+            for (mask_type _m = _alive_mask; _m != 0; _m &= _m - 1) {
+                const size_t _j = std::countr_zero(_m);
+                if (_machines[_j].absorbing(_q[_j])) { // the result can not change any more
+                    _alive_mask &= ~(mask_type(1) << _j);
+                    continue;
+                }
+                const state_id _n = _M_next(_j, _q[_j], _c);
+                if (_n == dfa::npos) {
+                    _alive_mask &= ~(mask_type(1) << _j);
+                    _r[_j].length = _i;
+                    continue;
+                }
+                _q[_j] = _n;
+            }
+        }
+        for (size_t _j = 0; _j != size(); ++_j) {
+            _r[_j].accepted = _machines[_j].acceptable(_q[_j]);
+        }
+    }
+private:
+    std::vector<dfa> _machines;
+    std::array<dfa::class_id, dfa::alphabet_size> _classes = {};
+    size_t _class_count = 0;
+    std::vector<dfa::class_id> _local; // (machine, common class) -> machine class
+    bool _product = false;
+    std::vector<state_id> _table; // product transition table
+    std::vector<mask_type> _alive; // product state -> machines not dead yet
+    std::vector<mask_type> _accept; // product state -> machines accepting
+    std::vector<std::uint8_t> _settled; // product state -> all machines not dead yet are absorbing
+};
+
+template <basic_state _Bs> auto dfa::compile(context<_Bs>& _f) -> self {
+    self _d;
+    if (_f._structure->_default_entry_state.empty()) return _d;
+    std::vector<state::label_type> _labels;
+    std::unordered_map<state::label_type, state_id> _ids;
+    auto _id_of = [&](state::label_type _l) -> state_id {
+        auto _it = _ids.find(_l);
+        if (_it != _ids.cend()) return _it->second;
+        const state_id _s = _d.add_state(_f._structure->_acceptable_states.contains(_l));
+        _ids.emplace(_l, _s);
+        _labels.push_back(_l);
+        return _s;
+    };
+    _f.stop();
+    const reset_policy _policy = _f._reset_policy;
+    _f._reset_policy = reset_policy::touched;
+    _d.entry(_id_of(_f._structure->_default_entry_state));
+    for (size_t _i = 0; _i != _labels.size(); ++_i) {
+        for (size_t _b = 0; _b != alphabet_size; ++_b) {
+            _f._M_reset();
+            _f._state = _f._M_index(_labels[_i]);
+            _f._M_touch(_f._state);
+            if (character::handle(_f, static_cast<char>(_b))) {
+                _d.link(static_cast<state_id>(_i), static_cast<unsigned char>(_b), _id_of(_f._structure->_nodes[_f._state]._label));
+            }
+        }
+    }
+    _f._state = context<_Bs>::npos;
+    _f._M_reset();
+    _f._reset_policy = _policy;
+    _d.analyze();
+    return _d;
+}
+
+}
+
+}
+
+#endif // _ICY_FINITE_AUTOMATON_HPP_
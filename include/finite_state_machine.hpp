@@ -6,15 +6,33 @@
 
 #include <cassert>
 #include <cstdio>
+#include <cstring>
+#include <cstdint>
 
 #include <string>
+#include <string_view>
+#include <array>
 
 #include <unordered_set>
 #include <unordered_map>
+#include <vector>
 #include <memory>
+#include <memory_resource>
+#include <atomic>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <utility>
+#include <new>
+#include <cstddef>
+#include <bit>
 
 #include <source_location>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 namespace icy {
 
 namespace fsm {
@@ -29,12 +47,114 @@ template <typename _Bt> concept basic_state = std::derived_from<_Bt, state>;
 }
 
 template <basic_state _Bs> class context;
+template <basic_state _Bs> class event_registry;
+class dfa;
 
 /**
  * @brief 有限状态机的事件基类
  */
 struct event {};
 
+/**
+ * @brief 事件类型编号
+ * @details 每个事件类型在首次使用时获得一个从 0 开始的紧凑编号
+ */
+struct event_index {
+    template <typename _Et> requires std::derived_from<_Et, event>
+    static size_t of() {
+        static const size_t _i = _S_count.fetch_add(1, std::memory_order_relaxed);
+        return _i;
+    }
+private:
+    inline static std::atomic<size_t> _S_count = 0;
+};
+
+/**
+ * @brief 事件类型列表
+ * @details 用于声明状态处理的事件类型（按事件类型精确匹配），列表中包含 @c event 时表示处理所有事件
+ */
+template <typename... _Ets> requires (std::derived_from<_Ets, event> && ...)
+struct events {
+    static std::vector<size_t> indices() {
+        return {event_index::of<_Ets>()...};
+    }
+    static constexpr bool any() {
+        return (std::is_same<_Ets, event>::value || ...);
+    }
+};
+
+/**
+ * @brief 纯状态的副作用：无
+ * @details 纯状态声明 <tt>typedef fsm::no_action pure_action;</tt>
+ */
+struct no_action {
+    template <typename _Bt> static void apply(_Bt&) {}
+};
+/**
+ * @brief 纯状态的副作用：数据成员自增
+ * @details 例如 <tt>typedef fsm::increment<&float_recognition_state::_length> pure_action;</tt>
+ */
+template <auto _Mp> struct increment {
+    template <typename _Bt> static void apply(_Bt& _s) { ++(_s.*_Mp); }
+};
+
+/**
+ * @brief 类型擦除的事件
+ * @details 保存事件类型编号与事件对象的副本（内联存储，要求事件可平凡复制且不超过 @c capacity 字节）
+ */
+class envelope {
+    typedef envelope self;
+public:
+    static constexpr size_t capacity = 32;
+    static constexpr size_t npos = static_cast<size_t>(-1);
+    envelope() = default;
+    template <typename _Et> requires std::derived_from<_Et, event> &&
+    std::is_trivially_copyable<_Et>::value && (sizeof(_Et) <= capacity) && (alignof(_Et) <= alignof(std::max_align_t))
+    envelope(const _Et& _e) : _id(event_index::of<_Et>()), _size(sizeof(_Et)) {
+        std::memcpy(_data, &_e, sizeof(_Et));
+    }
+    /**
+     * @brief 由事件类型编号与事件对象的字节构造（用于从记录中恢复事件）
+     */
+    envelope(size_t _id, const void* _bytes, size_t _size) : _id(_id), _size(_size) {
+        assert(_size <= capacity);
+        std::memcpy(_data, _bytes, _size);
+    }
+    envelope(const self&) = default;
+    self& operator=(const self&) = default;
+    ~envelope() = default;
+    /**
+     * @brief 事件类型编号
+     */
+    size_t id() const { return _id; }
+    const void* data() const { return _data; }
+    size_t size() const { return _size; }
+    /**
+     * @brief 取出事件对象
+     * @tparam _Et 事件类型（必须与构造时的类型一致）
+     */
+    template <typename _Et> requires std::derived_from<_Et, event>
+    const _Et& get() const {
+        assert(_id == event_index::of<_Et>());
+        return *std::launder(reinterpret_cast<const _Et*>(_data));
+    }
+    /**
+     * @brief 事件类型与内容均相同
+     */
+    bool operator==(const self& _e) const {
+        return _id == _e._id && std::memcmp(_data, _e._data, _size) == 0;
+    }
+private:
+    size_t _id = npos;
+    size_t _size = 0;
+    alignas(std::max_align_t) unsigned char _data[capacity] = {};
+};
+
+/**
+ * @brief 可以放入 envelope 的事件类型
+ */
+template <typename _Et> concept envelope_event = std::is_constructible<envelope, const _Et&>::value;
+
 #define FSM_STATE_LABEL \
 static constexpr auto label() -> std::string_view { \
     std::string_view _name = std::source_location::current().function_name(); \
@@ -103,6 +223,129 @@ private:
     template <basic_state _Bs> friend class context;
 };
 
+/**
+ * @brief 冷数据成员
+ * @details 很少访问的状态数据（配置、调试信息等）存放在状态对象之外，使状态对象中的热数据更紧凑；复制时深复制。
+ * @tparam _Tp 数据类型
+ */
+template <typename _Tp> class cold {
+    typedef cold<_Tp> self;
+public:
+    cold() : _ptr(std::make_unique<_Tp>()) {}
+    cold(const _Tp& _v) : _ptr(std::make_unique<_Tp>(_v)) {}
+    cold(const self& _c) : self(*_c) {}
+    self& operator=(const self& _c) { *_ptr = *_c; return *this; }
+    self& operator=(const _Tp& _v) { *_ptr = _v; return *this; }
+    ~cold() = default;
+    _Tp& operator*() { return *_ptr; }
+    const _Tp& operator*() const { return *_ptr; }
+    _Tp* operator->() { return _ptr.get(); }
+    const _Tp* operator->() const { return _ptr.get(); }
+private:
+    std::unique_ptr<_Tp> _ptr;
+};
+
+/**
+ * @brief 撤销日志
+ * @details 事务中（context::transactional）对 tracked 数据成员的写入先记录原值，事件被拒绝时按相反顺序恢复，被接受时丢弃记录。
+ * 当前线程正在使用的日志由 scope 设置；可以设置过滤函数，只记录属于某个对象（例如状态机的状态对象）的写入。
+ */
+class undo_log {
+    typedef undo_log self;
+public:
+    static constexpr size_t capacity = 16; // max size of a tracked value
+    typedef bool (*filter_type)(const void* _owner, const void* _p);
+    /**
+     * @brief 在作用域内把 _l 设为当前线程的日志
+     */
+    class scope {
+    public:
+        explicit scope(undo_log& _l) : _previous(_S_current) { _S_current = &_l; }
+        scope(const scope&) = delete;
+        scope& operator=(const scope&) = delete;
+        ~scope() { _S_current = _previous; }
+    private:
+        undo_log* const _previous;
+    };
+    undo_log() = default;
+    /**
+     * @brief 只记录 _filter(_owner, 地址) 为 true 的写入
+     */
+    undo_log(const void* _owner, filter_type _filter) : _owner(_owner), _filter(_filter) {}
+    undo_log(const self&) = delete;
+    self& operator=(const self&) = delete;
+    ~undo_log() = default;
+public:
+    /**
+     * @brief 当前线程的日志，不在事务中时为 nullptr
+     */
+    static undo_log* current() { return _S_current; }
+    /**
+     * @brief 记录 _p 处 _n 个字节的原值（被过滤函数排除的写入不记录）
+     */
+    void record(void* _p, size_t _n) {
+        assert(_n <= capacity);
+        if (_filter != nullptr && !_filter(_owner, _p)) return;
+        entry& _e = _entries.emplace_back();
+        _e._address = _p;
+        _e._size = _n;
+        std::memcpy(_e._bytes.data(), _p, _n);
+    }
+    void rollback() {
+        for (auto _it = _entries.crbegin(); _it != _entries.crend(); ++_it) {
+            std::memcpy(_it->_address, _it->_bytes.data(), _it->_size);
+        }
+        _entries.clear();
+    }
+    void commit() { _entries.clear(); }
+    size_t size() const { return _entries.size(); }
+private:
+    struct entry {
+        void* _address;
+        size_t _size;
+        std::array<unsigned char, capacity> _bytes;
+    };
+    std::vector<entry> _entries; // capacity is kept between events
+    const void* const _owner = nullptr;
+    const filter_type _filter = nullptr;
+    inline static thread_local undo_log* _S_current = nullptr;
+};
+
+/**
+ * @brief 可撤销的数据成员
+ * @details 写入时若当前线程在事务中，先在撤销日志中记录原值；不在事务中时只多一次判断。复制构造不记录。
+ * 状态机的撤销日志只记录它自己的状态对象中的写入，处理函数中写入的其他对象（包括其他状态机的状态）不被恢复。
+ * @tparam _Tp 可平凡复制、不超过 undo_log::capacity 字节的数据类型
+ */
+template <typename _Tp> requires std::is_trivially_copyable<_Tp>::value && (sizeof(_Tp) <= undo_log::capacity)
+class tracked {
+    typedef tracked<_Tp> self;
+public:
+    tracked() = default;
+    tracked(const _Tp& _v) : _val(_v) {}
+    tracked(const self&) = default;
+    self& operator=(const self& _t) { _M_log(); _val = _t._val; return *this; }
+    self& operator=(const _Tp& _v) { _M_log(); _val = _v; return *this; }
+    ~tracked() = default;
+    operator const _Tp&() const { return _val; }
+    const _Tp& get() const { return _val; }
+    self& operator+=(const _Tp& _v) { _M_log(); _val += _v; return *this; }
+    self& operator-=(const _Tp& _v) { _M_log(); _val -= _v; return *this; }
+    self& operator*=(const _Tp& _v) { _M_log(); _val *= _v; return *this; }
+    self& operator/=(const _Tp& _v) { _M_log(); _val /= _v; return *this; }
+    self& operator++() { _M_log(); ++_val; return *this; }
+    self& operator--() { _M_log(); --_val; return *this; }
+    _Tp operator++(int) { _M_log(); return _val++; }
+    _Tp operator--(int) { _M_log(); return _val--; }
+private:
+    void _M_log() {
+        if (undo_log* const _l = undo_log::current(); _l != nullptr) [[unlikely]] {
+            _l->record(&_val, sizeof(_Tp));
+        }
+    }
+    _Tp _val = {};
+};
+
 namespace {
 
 template <typename _Bt, typename _St> concept label_state = 
@@ -110,8 +353,75 @@ basic_state<_Bt> &&
 std::derived_from<_St, _Bt> && // std::is_base_of<_Bt, _St>::value
 requires { {_St::label()} -> std::same_as<state::label_type>; };
 
+/**
+ * @brief 声明了父状态 @c parent_type 的状态
+ */
+template <typename _St> concept nested_state = requires {
+    typename _St::parent_type;
+    {_St::parent_type::label()} -> std::same_as<state::label_type>;
+};
+
+/**
+ * @brief 声明了所处理事件列表 @c handled_events 的状态，未列出的事件交给父状态处理
+ */
+template <typename _St> concept selective_state = requires { typename _St::handled_events; };
+
+/**
+ * @brief 声明了副作用 @c pure_action 的纯状态
+ * @details 对每个事件类型，处理结果（转移到的状态）只取决于状态与事件类型，唯一的副作用是 pure_action
+ */
+template <typename _St> concept pure_state = requires { typename _St::pure_action; };
+
+/**
+ * @brief 提供计数的事件处理函数 <tt>size_t handle(const _Et&, size_t)</tt> 的状态
+ */
+template <typename _Bt, typename _Et> concept counted_handler = requires(_Bt& _s, const _Et& _e, size_t _n) {
+    {_s.handle(_e, _n)} -> std::same_as<size_t>;
+};
+
 }
 
+/**
+ * @brief 事件记录接口
+ * @details 通过 context::trace 挂载后，每次 context::handle 处理完可以放入 envelope 的事件后调用
+ */
+class tracer {
+public:
+    virtual ~tracer() = default;
+    /**
+     * @param _name 事件类型名（typeid 名）
+     * @param _data 事件对象
+     * @param _size 事件对象大小
+     * @param _result 处理结果
+     * @param _state 处理后的状态
+     */
+    virtual void record(const char* _name, const void* _data, size_t _size, bool _result, state::label_type _state) = 0;
+};
+
+/**
+ * @brief 状态发布接口
+ * @details 通过 context::observe 挂载后，每次状态切换（包括重入）以及关闭结束时，由驱动状态机的线程调用
+ */
+class observer {
+public:
+    virtual ~observer() = default;
+    /**
+     * @param _s 当前状态（关闭后为 nullptr）
+     * @param _label 当前状态的键（关闭后为空）
+     * @param _acceptable 当前状态是否可接受
+     */
+    virtual void publish(const state* _s, state::label_type _label, bool _acceptable) = 0;
+};
+
+/**
+ * @brief 状态机关闭（重启）时的状态重置策略
+ */
+enum class reset_policy {
+    all, // 重置所有已注册状态（默认）
+    touched, // 只重置自启动以来被进入或被赋值的状态
+    entry, // 不在关闭时重置，启动时只重置初始状态（及其祖先状态）；要求状态数据完全由 assign 在状态间传递
+};
+
 /**
  * @brief 有限状态机
  * @tparam _Bs 有限状态类型
@@ -119,20 +429,46 @@ requires { {_St::label()} -> std::same_as<state::label_type>; };
 template <basic_state _Bs> class context {
     typedef context<_Bs> self;
     // using label_type = state::label_type;
+    static constexpr size_t npos = static_cast<size_t>(-1);
 public:
     // derived from fsm::state
     typedef _Bs state_type;
+    static constexpr size_t cache_line = 64;
+    /**
+     * @brief 内存布局报告
+     * @details 状态对象由同一块内存连续分配；写时复制产生的状态对象不在其中
+     */
+    struct layout_report {
+        size_t states = 0;
+        size_t state_bytes = 0; // sizeof of all state objects
+        size_t span_bytes = 0; // address range covered by state objects
+        size_t state_lines = 0; // cache lines covered by state objects
+        size_t handle_lines = 0; // max cache lines of state objects touched by one handle
+        size_t context_bytes = 0; // context and its tables, excluding state objects
+    };
     context() = default;
     context(const self&) = delete;
     self& operator=(const self&) = delete;
     ~context() = default;
+private:
+    /**
+     * @brief 派生子状态机
+     */
+    explicit context(self& _origin)
+    : _structure(_origin._structure), _state(_origin._state), _arena(_origin._arena), _states(_origin._states), _origin(&_origin),
+    _reset_policy(_origin._reset_policy), _touched(_origin._touched), _dirty(_origin._dirty), _transactional(_origin._transactional) {}
 public:
     /**
      * @brief 状态注册
      * @tparam _Sts 状态类型
      */
     template <typename... _Sts> void enroll() {
+        _M_detach();
+        if (_arena == nullptr) { // states of a machine are allocated contiguously
+            _arena = std::make_shared<std::pmr::monotonic_buffer_resource>(((sizeof(_Sts) + cache_line) + ...));
+        }
         _M_enroll<_Sts...>();
+        _M_compile();
     };
     /**
      * @brief 事件处理
@@ -141,21 +477,83 @@ public:
      * @retval true 状态处理正常
      * @retval false 状态处理出错
      * @implements state::handle -> state::transit -> context::_M_transit
+     * @details 层次状态机中，事件由当前状态及其祖先中最近的声明处理该事件的状态处理（查表，不遍历父状态链）
      */
     template <typename _Et> requires std::derived_from<_Et, event>
     bool handle(const _Et& _e) {
-        state::label_type _ns = _M_state()->handle(_e);
-        if (state::null_label(_ns)) {
-            _ns = _M_state()->transit();
-            if (state::null_label(_ns)) { // reentry the current state
-                _ns = _state;
+        const bool _r = (_transactional ? _M_handle_transaction(_e) : _M_handle(_e));
+        if constexpr (envelope_event<_Et>) {
+            if (_tracer != nullptr) [[unlikely]] {
+                _tracer->record(typeid(_Et).name(), &_e, sizeof(_Et), _r, label());
             }
         }
-        if (state::invalid_label(_ns)) {
-            return false;
+        return _r;
+    }
+    /**
+     * @brief 批量事件处理：同一事件连续处理 _n 次
+     * @return 处理正常的事件数，遇到处理出错的事件时停止
+     * @details 若处理该事件的状态提供计数的处理函数
+     * <tt>size_t handle(const _Et&, size_t _n)</tt>，则一次吸收前 k 个事件（0 <= k <= _n），约定：
+     * - 前 k - 1 个事件不引起状态转移，只在第 k 个事件之后调用一次 transit；
+     * - 返回 0 表示不吸收，该事件按 handle(_e) 处理。
+     *
+     * 处理正常的事件数、最终状态与状态数据与逐个调用 handle(_e) 相同（由计数的处理函数保证），
+     * 但吸收的 k 个事件合并了以下逐事件的副作用：只调用一次 transit、一次状态切换（重入时的 exit/entry 各一次，
+     * 而不是 k 次）、层次状态机中祖先与当前状态之间的 assign 各一次，挂载的状态发布（observe）只发布一次。
+     * 状态转移后剩余的事件由新状态继续处理。挂载了事件记录或处于事务模式时逐个处理，没有合并。
+     */
+    template <typename _Et> requires std::derived_from<_Et, event>
+    size_t handle_n(const _Et& _e, size_t _n) {
+        if constexpr (counted_handler<state_type, _Et>) {
+            if (_tracer == nullptr && !_transactional) {
+                size_t _done = 0;
+                while (_done != _n && _M_handle_n(_e, _n - _done, _done));
+                return _done;
+            }
         }
-        _M_transit(_ns);
-        return true;
+        for (size_t _i = 0; _i != _n; ++_i) {
+            if (!handle(_e)) return _i;
+        }
+        return _n;
+    }
+    /**
+     * @brief 批量事件处理（类型擦除的事件）
+     * @details 事件类型未注册时返回 0
+     */
+    size_t handle_n(const envelope& _e, size_t _n) {
+        return event_registry<_Bs>::dispatch_n(_e.id())(*this, _e.data(), _n);
+    }
+    /**
+     * @brief 事件处理（类型擦除的事件）
+     * @details 通过 event_registry 的跳转表分派到对应事件类型的 handle
+     * @retval false 状态处理出错，或事件类型未注册（空的 envelope 也是如此，状态不变）
+     */
+    bool handle(const envelope& _e) {
+        return event_registry<_Bs>::dispatch(_e.id())(*this, _e.data());
+    }
+    /**
+     * @brief 挂载事件记录（nullptr 表示不记录）
+     * @details 只记录可以放入 envelope 的事件；派生的子状态机不记录
+     */
+    void trace(tracer* _t) {
+        _tracer = _t;
+    }
+    /**
+     * @brief 事务模式
+     * @details 开启后每次 handle 是一个事务：状态数据中 tracked 成员的写入记录在撤销日志中，
+     * 事件被拒绝（处理出错或抛出异常）时恢复原值，被接受时丢弃记录，不复制状态对象。其他数据成员不恢复。
+     * 只记录本状态机的状态对象中的写入，处理函数写入的其他 tracked 对象不恢复。
+     */
+    void transactional(bool _on) {
+        _transactional = _on;
+    }
+    /**
+     * @brief 挂载状态发布（nullptr 表示不发布），挂载时立即发布一次当前状态
+     * @details 派生的子状态机不发布，提交（commit）时由派生它的状态机发布
+     */
+    void observe(observer* _o) {
+        _observer = _o;
+        _M_publish();
     }
     /**
      * @brief 状态初始化
@@ -163,13 +561,130 @@ public:
      */
     template <typename _St> requires label_state<_Bs, _St>
     void start() {
-        _M_transit(_St::label());
+        _M_transit(_M_index(_St::label()));
+    }
+private:
+    /**
+     * @brief 撤销日志的过滤函数：_p 是否位于 _f 的状态对象中
+     * @details 只在事务中的写入时调用，代价与状态数成正比
+     */
+    static bool _S_owns(const void* _f, const void* _p) {
+        const self& _s = *static_cast<const self*>(_f);
+        const std::uintptr_t _a = reinterpret_cast<std::uintptr_t>(_p);
+        for (size_t _i = 0; _i != _s._states.size(); ++_i) {
+            const std::uintptr_t _b = reinterpret_cast<std::uintptr_t>(_s._states[_i].get());
+            if (_a >= _b && _a < _b + _s._structure->_nodes[_i]._size) return true;
+        }
+        return false;
+    }
+    template <typename _Et> bool _M_handle_transaction(const _Et& _e) {
+        const undo_log::scope _scope(_undo);
+        bool _r;
+        try {
+            _r = _M_handle(_e);
+        }
+        catch (...) {
+            _undo.rollback();
+            throw;
+        }
+        if (_r) _undo.commit();
+        else _undo.rollback();
+        return _r;
+    }
+    template <typename _Et> bool _M_handle(const _Et& _e) {
+        if (_structure->_pure) {
+            return _M_handle_pure(_e);
+        }
+        state_type* const _cur = _M_state();
+        state_type* const _h = _M_handler<_Et>(_cur);
+        const state::label_type _ns = _h->handle(_e);
+        if (_h != _cur) _cur->assign(*_h);
+        return _M_settle(_cur, _ns);
+    }
+    /**
+     * @brief 查 (状态, 事件类型) -> 转移到的状态 的缓存，未命中时正常处理并填入缓存
+     * @details 只缓存当前状态是纯状态、由它自己处理事件、且 handle 直接给出合法状态名的结果。
+     * 由祖先处理或由 transit 决定的转移可能取决于数据，不缓存。命中时不调用 handle 与 transit
+     */
+    template <typename _Et> bool _M_handle_pure(const _Et& _e) {
+        const size_t _k = _M_memo(event_index::of<_Et>());
+        const size_t _m = _structure->_memo[_k];
+        if (_m >= memo_base) {
+            _structure->_nodes[_state]._action(*_M_state());
+            _M_transit(_m - memo_base);
+            return true;
+        }
+        const size_t _from = _state;
+        state_type* const _cur = _M_state();
+        state_type* const _h = _M_handler<_Et>(_cur);
+        const state::label_type _ns = _h->handle(_e);
+        if (_h != _cur) _cur->assign(*_h);
+        const bool _r = _M_settle(_cur, _ns);
+        if (_m == memo_unknown) {
+            const bool _cacheable = _r && _h == _cur && !state::null_label(_ns) && _structure->_nodes[_from]._action != nullptr;
+            _structure->_memo[_k] = (_cacheable ? _state + memo_base : memo_opaque);
+        }
+        return _r;
+    }
+    /**
+     * @brief 由计数的处理函数处理至多 _n 个事件
+     * @param _done 累加处理正常的事件数
+     * @return 是否处理正常
+     */
+    template <typename _Et> bool _M_handle_n(const _Et& _e, size_t _n, size_t& _done) {
+        state_type* const _cur = _M_state();
+        state_type* const _h = _M_handler<_Et>(_cur);
+        const size_t _k = _h->handle(_e, _n);
+        assert(_k <= _n);
+        if (_k == 0) {
+            const state::label_type _ns = _h->handle(_e);
+            if (_h != _cur) _cur->assign(*_h);
+            if (!_M_settle(_cur, _ns)) return false;
+            ++_done;
+            return true;
+        }
+        if (_h != _cur) _cur->assign(*_h);
+        _done += _k - 1;
+        if (!_M_settle(_cur, state::label_type())) return false;
+        ++_done;
+        return true;
+    }
+    /**
+     * @brief 处理事件的状态：当前状态，或层次状态机中声明处理该事件的最近祖先（复制当前状态的数据）
+     */
+    template <typename _Et> state_type* _M_handler(state_type* _cur) {
+        if (!_structure->_nested) return _cur;
+        const size_t _i = _M_dispatch(event_index::of<_Et>())[_state];
+        state_type* const _h = _M_state(_i);
+        if (_h != _cur) {
+            _M_touch(_i);
+            _h->assign(*_cur);
+        }
+        return _h;
+    }
+    /**
+     * @brief 根据处理结果转移状态
+     */
+    bool _M_settle(state_type* _cur, state::label_type _ns) {
+        if (state::null_label(_ns)) {
+            _ns = _cur->transit();
+            if (state::null_label(_ns)) { // reentry the current state
+                _M_transit(_state);
+                return true;
+            }
+        }
+        if (state::invalid_label(_ns)) {
+            return false;
+        }
+        _M_transit(_M_index(_ns));
+        return true;
     }
+public:
     /**
      * @brief 状态初始化
      */
     void start() {
-        _M_transit(_default_entry_state);
+        _M_transit(_M_index(_structure->_default_entry_state));
     }
     /**
      * @brief 状态重置
@@ -192,6 +707,7 @@ public:
      * @tparam _Sts 状态类型
      */
     template <typename... _Sts> void accept() {
+        _M_detach();
         _M_accept<_Sts...>();
     }
     /**
@@ -200,6 +716,7 @@ public:
      * @tparam _Sts 状态类型
      */
     template <typename... _Sts> void reject() {
+        _M_detach();
         _M_reject<_Sts...>();
     }
     /**
@@ -208,27 +725,123 @@ public:
      */
     template <typename _St> requires label_state<_Bs, _St>
     void default_entry() {
-        this->_default_entry_state = _St::label();
+        _M_detach();
+        _structure->_default_entry_state = _St::label();
+    }
+    /**
+     * @brief 状态重置策略
+     * @details 默认重置所有已注册状态；reset() 没有副作用时可以选择 touched，只重置自启动以来被进入或被赋值的状态
+     */
+    void reset_with(reset_policy _p) {
+        this->_reset_policy = _p;
     }
     /**
      * @brief 关闭状态机
      */
     void stop() {
-        if (state::null_label(_state)) return;
-        _M_state()->exit();
-        _state = {};
+        if (_state == npos) return;
+        if (_structure->_nested) {
+            const route& _r = _M_route(_state, npos);
+            for (size_t _i = _r._exit_begin; _i != _r._exit_end; ++_i) {
+                _M_state(_structure->_steps[_i])->exit();
+            }
+        }
+        else {
+            _M_state()->exit();
+        }
+        _state = npos;
         _M_reset();
+        _M_publish();
+    }
+    /**
+     * @brief 内存布局报告
+     */
+    layout_report layout() const {
+        layout_report _r;
+        _r.states = _states.size();
+        _r.context_bytes = sizeof(self) + sizeof(structure) + _states.size() * sizeof(_states[0])
+            + _structure->_nodes.size() * sizeof(node) + _structure->_routes.size() * sizeof(route)
+            + _structure->_steps.size() * sizeof(size_t);
+        for (const auto& _d : _structure->_dispatch) {
+            _r.context_bytes += _d.size() * sizeof(size_t);
+        }
+        std::uintptr_t _low = std::numeric_limits<std::uintptr_t>::max(), _high = 0;
+        std::vector<std::uintptr_t> _lines;
+        for (size_t _i = 0; _i != _states.size(); ++_i) {
+            const std::uintptr_t _b = reinterpret_cast<std::uintptr_t>(_states[_i].get());
+            const std::uintptr_t _e = _b + _structure->_nodes[_i]._size;
+            _r.state_bytes += _structure->_nodes[_i]._size;
+            _low = std::min(_low, _b);
+            _high = std::max(_high, _e);
+            for (std::uintptr_t _l = _b / cache_line; _l <= (_e - 1) / cache_line; ++_l) {
+                _lines.push_back(_l);
+            }
+        }
+        if (_states.empty()) return _r;
+        _r.span_bytes = _high - _low;
+        std::sort(_lines.begin(), _lines.end());
+        _r.state_lines = std::unique(_lines.begin(), _lines.end()) - _lines.begin();
+        for (size_t _i = 0; _i != _states.size(); ++_i) { // the current state, and its ancestor handling the event
+            const std::uintptr_t _b = reinterpret_cast<std::uintptr_t>(_states[_i].get());
+            size_t _n = (_b + _structure->_nodes[_i]._size - 1) / cache_line - _b / cache_line + 1;
+            size_t _m = 0;
+            for (size_t _p = _structure->_nodes[_i]._parent; _p != npos; _p = _structure->_nodes[_p]._parent) {
+                const std::uintptr_t _a = reinterpret_cast<std::uintptr_t>(_states[_p].get());
+                _m = std::max(_m, (_a + _structure->_nodes[_p]._size - 1) / cache_line - _a / cache_line + 1);
+            }
+            _r.handle_lines = std::max(_r.handle_lines, _n + _m);
+        }
+        return _r;
+    }
+    /**
+     * @brief 派生子状态机（用于试探性的解析）
+     * @details 子状态机与当前状态机共享状态机结构与状态对象，状态对象在任意一方首次修改时才复制（写时复制，通过 state::assign 复制数据）。
+     * 子状态机的生命周期不应超过当前状态机。
+     */
+    self fork() {
+        return self(*this);
+    }
+    /**
+     * @brief 将子状态机的当前状态与状态数据提交给派生它的状态机
+     */
+    void commit() {
+        assert(_origin != nullptr);
+        _origin->_structure = _structure;
+        _origin->_states = _states;
+        _origin->_state = _state;
+        _origin->_reset_policy = _reset_policy;
+        _origin->_touched = _touched;
+        _origin->_dirty = _dirty;
+        _origin->_M_publish();
+    }
+    /**
+     * @brief 放弃子状态机的修改，恢复为派生它的状态机的当前状态与状态数据
+     */
+    void rollback() {
+        assert(_origin != nullptr);
+        _structure = _origin->_structure;
+        _states = _origin->_states;
+        _state = _origin->_state;
+        _reset_policy = _origin->_reset_policy;
+        _touched = _origin->_touched;
+        _dirty = _origin->_dirty;
     }
     /**
      * @brief 当前状态是否可接受
      */
     bool acceptable() const {
-        return _acceptable_states.contains(_state);
+        return _state != npos && _structure->_acceptable_states.contains(_structure->_nodes[_state]._label);
     }
     /**
      * @brief 返回当前状态
      */
-    inline const state_type* state() const { return _M_state(_state); }
+    inline const state_type* state() const { return _M_state(); }
+    /**
+     * @brief 返回当前状态的键（未启动时为空）
+     */
+    state::label_type label() const {
+        return (_state == npos ? state::label_type() : _structure->_nodes[_state]._label);
+    }
 private:
     /**
      * @brief 状态注册
@@ -236,7 +849,40 @@ private:
      */
     template <typename _St, typename... _Sts> requires label_state<_Bs, _St>
     void _M_enroll() {
-        _states.emplace(_St::label(), std::make_shared<_St>());
+        if (!_structure->_indices.contains(_St::label())) {
+            _structure->_indices.emplace(_St::label(), _states.size());
+            _states.emplace_back(std::allocate_shared<_St>(std::pmr::polymorphic_allocator<_St>(_arena.get())));
+            _dirty.push_back(false);
+            node _n;
+            _n._label = _St::label();
+            _n._size = sizeof(_St);
+            _n._clone = [](const state_type& _s) -> std::shared_ptr<state_type> {
+                const std::shared_ptr<_St> _c = std::make_shared<_St>();
+                if constexpr (std::is_copy_assignable<_St>::value) {
+                    *_c = static_cast<const _St&>(_s);
+                }
+                else {
+                    _c->assign(_s);
+                }
+                return _c;
+            };
+            if constexpr (nested_state<_St>) {
+                if constexpr (!std::is_same<typename _St::parent_type, _St>::value) {
+                    _n._parent_label = _St::parent_type::label();
+                }
+            }
+            if constexpr (selective_state<_St>) {
+                _n._handled = _St::handled_events::indices();
+                _n._handles_all = _St::handled_events::any();
+            }
+            else {
+                _n._handles_all = true;
+            }
+            if constexpr (pure_state<_St>) {
+                _n._action = [](state_type& _s) { _St::pure_action::apply(_s); };
+            }
+            _structure->_nodes.emplace_back(std::move(_n));
+        }
         if constexpr (sizeof...(_Sts) != 0) {
             _M_enroll<_Sts...>();
         }
@@ -247,7 +893,7 @@ private:
      */
     template <typename _St, typename... _Sts> requires label_state<_Bs, _St>
     void _M_accept() {
-        this->_acceptable_states.emplace(_St::label());
+        _structure->_acceptable_states.emplace(_St::label());
         if constexpr (sizeof...(_Sts) != 0) {
             _M_accept<_Sts...>();
         }
@@ -259,16 +905,37 @@ private:
      */
     template <typename _St, typename... _Sts> requires label_state<_Bs, _St>
     void _M_reject() {
-        this->_acceptable_states.erase(_St::label());
+        _structure->_acceptable_states.erase(_St::label());
         if constexpr (sizeof...(_Sts) != 0) {
             _M_reject<_Sts...>();
         }
     }
-    const state_type* _M_state(state::label_type _s) const {
-        return (_states.contains(_s) ? _states.at(_s).get() : nullptr);
+    size_t _M_index(state::label_type _s) const {
+        const auto _it = _structure->_indices.find(_s);
+        return (_it != _structure->_indices.cend() ? _it->second : npos);
     }
-    state_type* _M_state(state::label_type _s) {
-        return (_states.contains(_s) ? _states.at(_s).get() : nullptr);
+    const state_type* _M_state(size_t _i) const {
+        return (_i < _states.size() ? _states[_i].get() : nullptr);
+    }
+    /**
+     * @brief 可修改的状态对象
+     * @details 状态对象与其他（派生的）状态机共享时，先复制（写时复制）：默认构造后按具体类型的复制赋值复制全部数据；
+     * 不可复制赋值的状态通过 assign 复制，此时须覆盖 assign
+     */
+    state_type* _M_state(size_t _i) {
+        if (_i >= _states.size()) return nullptr;
+        if (_states[_i].use_count() > 1) {
+            _states[_i] = _structure->_nodes[_i]._clone(*_states[_i]);
+        }
+        return _states[_i].get();
+    }
+    /**
+     * @brief 修改状态机结构前，与其他（派生的）状态机解除共享
+     */
+    void _M_detach() {
+        if (_structure.use_count() > 1) {
+            _structure = std::make_shared<structure>(*_structure);
+        }
     }
     const state_type* _M_state() const {
         return _M_state(_state);
@@ -280,29 +947,348 @@ private:
      * @brief reset state inner data
      */
     void _M_reset() {
-        for (auto& [_l, _s] : _states) {
-            _s->reset();
+        if (_reset_policy == reset_policy::all) {
+            for (size_t _i = 0; _i != _states.size(); ++_i) {
+                _M_state(_i)->reset();
+            }
+        }
+        else if (_reset_policy == reset_policy::touched) {
+            for (const size_t _i : _touched) {
+                _M_state(_i)->reset();
+            }
+        }
+        for (const size_t _i : _touched) {
+            _dirty[_i] = false;
+        }
+        _touched.clear();
+    }
+    /**
+     * @brief 记录自启动以来被进入或被赋值的状态
+     */
+    void _M_touch(size_t _i) {
+        if (_dirty[_i]) return;
+        _dirty[_i] = true;
+        _touched.push_back(_i);
+    }
+    /**
+     * @brief 解析层次结构，预先计算全部状态对之间的退出/进入序列
+     * @details 仅当存在父状态时才会生成转移路径表；事件分派表在首次处理该类型事件时生成
+     */
+    void _M_compile() {
+        const size_t _n = _structure->_nodes.size();
+        _structure->_nested = false;
+        _structure->_pure = false;
+        for (auto& _node : _structure->_nodes) {
+            _node._parent = (_node._parent_label.empty() ? npos : _M_index(_node._parent_label));
+            _structure->_nested = _structure->_nested || _node._parent != npos;
+            _structure->_pure = _structure->_pure || _node._action != nullptr;
+        }
+        _structure->_dispatch.clear();
+        _structure->_memo.clear();
+        _structure->_routes.clear();
+        _structure->_steps.clear();
+        if (!_structure->_nested) return;
+        auto _chain = [this](size_t _i) {
+            std::vector<size_t> _c;
+            for (; _i != npos && _c.size() <= _structure->_nodes.size(); _i = _structure->_nodes[_i]._parent) {
+                _c.push_back(_i);
+            }
+            assert(_c.size() <= _structure->_nodes.size()); // no cycle in hierarchy
+            return _c;
+        };
+        _structure->_routes.resize((_n + 1) * (_n + 1));
+        for (size_t _a = 0; _a <= _n; ++_a) {
+            const auto _ca = (_a == _n ? std::vector<size_t>() : _chain(_a));
+            for (size_t _b = 0; _b <= _n; ++_b) {
+                const auto _cb = (_b == _n ? std::vector<size_t>() : _chain(_b));
+                size_t _ea = _ca.size(), _eb = _cb.size(); // exit _ca[0, _ea), entry reversed _cb[0, _eb)
+                if (_a == _b) { // reentry
+                    _ea = _eb = std::min<size_t>(_ca.size(), 1);
+                }
+                else {
+                    for (size_t _i = 0; _i != _ca.size(); ++_i) {
+                        const auto _it = std::find(_cb.cbegin(), _cb.cend(), _ca[_i]);
+                        if (_it != _cb.cend()) {
+                            _ea = _i;
+                            _eb = _it - _cb.cbegin();
+                            break;
+                        }
+                    }
+                }
+                route& _r = _structure->_routes[_a * (_n + 1) + _b];
+                _r._exit_begin = _structure->_steps.size();
+                _structure->_steps.insert(_structure->_steps.end(), _ca.cbegin(), _ca.cbegin() + _ea);
+                _r._exit_end = _r._entry_begin = _structure->_steps.size();
+                _structure->_steps.insert(_structure->_steps.end(), std::make_reverse_iterator(_cb.cbegin() + _eb), _cb.crend());
+                _r._entry_end = _structure->_steps.size();
+            }
         }
     }
+    /**
+     * @brief 事件分派表：当前状态 -> 处理该事件的状态
+     * @param _e 事件类型编号
+     */
+    const std::vector<size_t>& _M_dispatch(size_t _e) {
+        if (_e >= _structure->_dispatch.size()) {
+            _structure->_dispatch.resize(_e + 1);
+        }
+        std::vector<size_t>& _d = _structure->_dispatch[_e];
+        if (_d.empty()) {
+            _d.resize(_structure->_nodes.size());
+            for (size_t _i = 0; _i != _structure->_nodes.size(); ++_i) {
+                size_t _h = _i;
+                while (_h != npos && !_structure->_nodes[_h].handles(_e)) {
+                    _h = _structure->_nodes[_h]._parent;
+                }
+                _d[_i] = (_h == npos ? _i : _h);
+            }
+        }
+        return _d;
+    }
+    static constexpr size_t memo_unknown = 0;
+    static constexpr size_t memo_opaque = 1; // handled by calling the state
+    static constexpr size_t memo_base = 2; // memo_base + next state
+    /**
+     * @return (当前状态, 事件类型) 在缓存中的下标
+     */
+    size_t _M_memo(size_t _e) {
+        const size_t _n = _structure->_nodes.size();
+        if ((_e + 1) * _n > _structure->_memo.size()) {
+            _structure->_memo.resize((_e + 1) * _n, memo_unknown);
+        }
+        return _e * _n + _state;
+    }
+    struct route {
+        size_t _exit_begin, _exit_end;
+        size_t _entry_begin, _entry_end;
+    };
+    const route& _M_route(size_t _from, size_t _to) const {
+        const size_t _n = _structure->_nodes.size();
+        return _structure->_routes[(_from == npos ? _n : _from) * (_n + 1) + (_to == npos ? _n : _to)];
+    }
     /**
      * @brief 状态切换
-     * @param _s 状态键（必须是合法的状态键）
+     * @param _s 状态编号（必须是合法的状态编号）
      * @implements state::assign -> state::exit -> state::entry
      */
-    void _M_transit(const state::label_type _s) {
-        assert(!state::null_label(_s) && !state::invalid_label(_s));
-        if (!state::null_label(_state)) {
-            _M_state(_s)->assign(*_M_state());
+    void _M_transit(const size_t _s) {
+        assert(_s < _states.size());
+        if (_structure->_nested) {
+            const route& _r = _M_route(_state, _s);
+            const state_type* const _src = std::as_const(*this)._M_state();
+            if (_src != nullptr) {
+                _M_state(_s)->assign(*_src);
+            }
+            else if (_reset_policy == reset_policy::entry) {
+                for (size_t _i = _r._entry_begin; _i != _r._entry_end; ++_i) {
+                    _M_state(_structure->_steps[_i])->reset();
+                }
+            }
+            _M_touch(_s);
+            for (size_t _i = _r._exit_begin; _i != _r._exit_end; ++_i) {
+                state_type* const _x = _M_state(_structure->_steps[_i]);
+                if (_src != nullptr && _x != _src) _x->assign(*_src);
+                _M_touch(_structure->_steps[_i]);
+                _x->exit();
+            }
+            _state = _s;
+            for (size_t _i = _r._entry_begin; _i != _r._entry_end; ++_i) {
+                state_type* const _x = _M_state(_structure->_steps[_i]);
+                if (_src != nullptr && _structure->_steps[_i] != _s) _x->assign(*_src);
+                _M_touch(_structure->_steps[_i]);
+                _x->entry();
+            }
+            _M_publish();
+            return;
+        }
+        if (_state != npos) {
+            _M_state(_s)->assign(*std::as_const(*this)._M_state());
             _M_state()->exit();
         }
+        else if (_reset_policy == reset_policy::entry) {
+            _M_state(_s)->reset();
+        }
+        _M_touch(_s);
         _state = _s;
         _M_state()->entry();
+        _M_publish();
+    }
+    void _M_publish() const {
+        if (_observer != nullptr) [[unlikely]] {
+            _observer->publish(_M_state(), label(), acceptable());
+        }
+    }
+private:
+    /**
+     * @brief 状态在层次结构中的信息
+     */
+    struct node {
+        bool handles(size_t _e) const {
+            return _handles_all || std::find(_handled.cbegin(), _handled.cend(), _e) != _handled.cend();
+        }
+        state::label_type _label = {};
+        std::shared_ptr<state_type> (*_clone)(const state_type&) = nullptr; // copy on write, by the copy assignment of the concrete type; not in the arena
+        size_t _size = 0;
+        state::label_type _parent_label = {};
+        size_t _parent = npos;
+        std::vector<size_t> _handled;
+        bool _handles_all = false;
+        void (*_action)(state_type&) = nullptr; // side effect of a pure state
+    };
+    /**
+     * @brief 状态机结构（派生的子状态机共享同一结构，修改前复制）
+     */
+    struct structure {
+        state::label_type _default_entry_state = {};
+        std::unordered_set<state::label_type> _acceptable_states;
+        std::unordered_map<state::label_type, size_t> _indices;
+        std::vector<node> _nodes;
+        bool _nested = false;
+        std::vector<std::vector<size_t>> _dispatch; // cache, filled on demand
+        bool _pure = false;
+        std::vector<size_t> _memo; // (event, state) -> transition, filled on demand
+        std::vector<route> _routes;
+        std::vector<size_t> _steps;
+    };
+    std::shared_ptr<structure> _structure = std::make_shared<structure>();
+    size_t _state = npos;
+    std::shared_ptr<std::pmr::monotonic_buffer_resource> _arena; // destroyed after _states
+    std::vector<std::shared_ptr<state_type>> _states;
+    self* _origin = nullptr;
+    tracer* _tracer = nullptr;
+    observer* _observer = nullptr;
+    reset_policy _reset_policy = reset_policy::all;
+    std::vector<size_t> _touched;
+    std::vector<std::uint8_t> _dirty;
+    bool _transactional = false;
+    undo_log _undo{this, &_S_owns};
+    friend class dfa;
+};
+
+/**
+ * @brief 事件注册表
+ * @details 为状态类型 @c _Bs 维护 事件类型编号 -> 处理函数 的跳转表，
+ * 使类型擦除的事件（envelope）以 O(1) 的代价分派到最匹配的 handle 重载。
+ * 注册应在状态机开始处理事件前完成。
+ * @tparam _Bs 有限状态类型
+ */
+template <basic_state _Bs> class event_registry {
+public:
+    typedef bool (*handler_type)(context<_Bs>&, const void*);
+    typedef size_t (*bulk_handler_type)(context<_Bs>&, const void*, size_t);
+    /**
+     * @brief 事件类型注册
+     * @tparam _Ets 事件类型
+     */
+    template <typename... _Ets> requires (std::derived_from<_Ets, event> && ...)
+    static void enroll() {
+        (_M_enroll<_Ets>(), ...);
+    }
+    /**
+     * @brief 事件类型是否已注册
+     */
+    static bool contains(size_t _id) {
+        return _id < _S_table.size() && _S_table[_id] != &_S_fallback;
+    }
+    static handler_type dispatch(size_t _id) {
+        return (_id < _S_table.size() ? _S_table[_id] : &_S_fallback);
+    }
+    static bulk_handler_type dispatch_n(size_t _id) {
+        return (_id < _S_bulk.size() ? _S_bulk[_id] : &_S_fallback_n);
+    }
+    /**
+     * @brief 按事件类型名（typeid 名）查找已注册的事件类型编号
+     * @return 未注册时返回 envelope::npos
+     */
+    static size_t find(std::string_view _name) {
+        const auto _it = _S_names.find(_name);
+        return (_it != _S_names.cend() ? _it->second : envelope::npos);
     }
 private:
-    state::label_type _state = {};
-    state::label_type _default_entry_state = {};
-    std::unordered_set<state::label_type> _acceptable_states;
-    std::unordered_map<state::label_type, std::shared_ptr<state_type>> _states;
+    template <typename _Et> static void _M_enroll() {
+        const size_t _id = event_index::of<_Et>();
+        _S_names.emplace(typeid(_Et).name(), _id);
+        if (_id >= _S_table.size()) {
+            _S_table.resize(_id + 1, &_S_fallback);
+            _S_bulk.resize(_id + 1, &_S_fallback_n);
+        }
+        _S_table[_id] = [](context<_Bs>& _f, const void* _e) -> bool {
+            return _f.handle(*std::launder(reinterpret_cast<const _Et*>(_e)));
+        };
+        _S_bulk[_id] = [](context<_Bs>& _f, const void* _e, size_t _n) -> size_t {
+            return _f.handle_n(*std::launder(reinterpret_cast<const _Et*>(_e)), _n);
+        };
+    }
+    /**
+     * @brief 未注册的事件类型：拒绝，不交给状态处理（事件内容无法还原）
+     */
+    static bool _S_fallback(context<_Bs>&, const void*) {
+        return false;
+    }
+    static size_t _S_fallback_n(context<_Bs>&, const void*, size_t) {
+        return 0;
+    }
+    inline static std::vector<handler_type> _S_table;
+    inline static std::vector<bulk_handler_type> _S_bulk;
+    inline static std::unordered_map<std::string_view, size_t> _S_names;
+};
+
+/**
+ * @brief 事件队列的合并器
+ * @details 连续相同（类型与内容均相同）的事件合并为一项与计数，交给 context::handle_n 处理
+ */
+class coalescer {
+    typedef coalescer self;
+public:
+    struct run {
+        envelope _event;
+        size_t _count;
+    };
+    coalescer() = default;
+    coalescer(const self&) = default;
+    self& operator=(const self&) = default;
+    ~coalescer() = default;
+public:
+    void push(const envelope& _e) {
+        if (!_runs.empty() && _runs.back()._event == _e) {
+            ++_runs.back()._count;
+        }
+        else {
+            _runs.push_back({_e, 1});
+        }
+        ++_events;
+    }
+    /**
+     * @brief 合并后的项数
+     */
+    size_t size() const { return _runs.size(); }
+    /**
+     * @brief 合并前的事件数
+     */
+    size_t events() const { return _events; }
+    bool empty() const { return _runs.empty(); }
+    const run& operator[](size_t _i) const { return _runs[_i]; }
+    void clear() {
+        _runs.clear();
+        _events = 0;
+    }
+    /**
+     * @brief 按顺序处理并清空队列
+     * @return 处理正常的事件数，遇到处理出错的事件时停止（其后的事件被丢弃）
+     */
+    template <basic_state _Bs> size_t flush(context<_Bs>& _f) {
+        size_t _done = 0;
+        for (const run& _r : _runs) {
+            const size_t _k = _f.handle_n(_r._event, _r._count);
+            _done += _k;
+            if (_k != _r._count) break;
+        }
+        clear();
+        return _done;
+    }
+private:
+    std::vector<run> _runs;
+    size_t _events = 0;
 };
 
 namespace character {
@@ -315,37 +1301,37 @@ private:
 };
 struct printable_code : public ascii_code {
     printable_code(char _c) : ascii_code(_c) {
-        if (!isprint(_c)) throw std::out_of_range("not printable code");
+        if (!isprint(static_cast<unsigned char>(_c))) throw std::out_of_range("not printable code");
     }
 };
 struct control_code : public ascii_code {
     control_code(char _c) : ascii_code(_c) {
-        if (isprint(_c)) throw std::out_of_range("not control code");
+        if (isprint(static_cast<unsigned char>(_c))) throw std::out_of_range("not control code");
     }
 };
 struct alnum : public printable_code { // a-zA-Z0-9
     alnum(char _c) : printable_code(_c) {
-        if (!isalnum(_c)) throw std::out_of_range("not in [a-zA-Z0-9]");
+        if (!isalnum(static_cast<unsigned char>(_c))) throw std::out_of_range("not in [a-zA-Z0-9]");
     }
 };
 struct alpha : public alnum { // a-zA-Z
     alpha(char _c) : alnum(_c) {
-        if (!isalpha(_c)) throw std::out_of_range("not in [a-zA-Z]");
+        if (!isalpha(static_cast<unsigned char>(_c))) throw std::out_of_range("not in [a-zA-Z]");
     }
 };
 struct lower_case : public alpha { // a-z
     lower_case(char _c) : alpha(_c) {
-        if (!islower(_c)) throw std::out_of_range("not in [a-z]");
+        if (!islower(static_cast<unsigned char>(_c))) throw std::out_of_range("not in [a-z]");
     }
 };
 struct upper_case : public alpha { // A-Z
     upper_case(char _c) : alpha(_c) {
-        if (!isupper(_c)) throw std::out_of_range("not in [A-Z]");
+        if (!isupper(static_cast<unsigned char>(_c))) throw std::out_of_range("not in [A-Z]");
     }
 };
 struct digit : public alnum { // 0-9
     digit(char _c) : alnum(_c) {
-        if (!isdigit(_c)) throw std::out_of_range("not in [0-9]");
+        if (!isdigit(static_cast<unsigned char>(_c))) throw std::out_of_range("not in [0-9]");
     }
 };
 
@@ -449,15 +1435,99 @@ struct ampersand : public printable_code { // &
     ampersand() : printable_code('&') {}
 };
 
+/**
+ * @brief UTF-8 编码的非 ASCII 字符
+ */
+struct unicode_code : public fsm::event {
+    constexpr unicode_code(char32_t _c): _val(_c) {}
+    inline constexpr char32_t value() const { return _val; }
+private:
+    const char32_t _val;
+};
+struct unicode_space : public unicode_code { // U+0085 U+00A0 U+1680 U+2000-U+200A U+2028 U+2029 U+202F U+205F U+3000
+    unicode_space(char32_t _c) : unicode_code(_c) {
+        if (!is_space(_c)) throw std::out_of_range("not unicode space");
+    }
+    static constexpr bool is_space(char32_t _c) {
+        return _c == 0x85 || _c == 0xa0 || _c == 0x1680 || (_c >= 0x2000 && _c <= 0x200a)
+            || _c == 0x2028 || _c == 0x2029 || _c == 0x202f || _c == 0x205f || _c == 0x3000;
+    }
+};
+/**
+ * @brief 非法的 UTF-8 字节序列（每个最长非法子序列对应一个事件）
+ */
+struct invalid_code : public fsm::event {
+    constexpr invalid_code(char _c): _val(_c) {}
+    inline constexpr char value() const { return _val; }
+private:
+    const char _val;
+};
+
+/**
+ * @brief UTF-8 解码结果
+ * @details 非法时 @c length 为最长非法子序列的长度
+ */
+struct utf8_sequence {
+    char32_t code = 0;
+    size_t length = 1;
+    bool valid = false;
+};
+/**
+ * @brief 解码 _s 开头的 UTF-8 字符（Unicode 标准表 3-7 中的合法序列）
+ */
+constexpr utf8_sequence decode(std::string_view _s) {
+    assert(!_s.empty());
+    const unsigned char _b = static_cast<unsigned char>(_s[0]);
+    if (_b < 0x80) return {_b, 1, true};
+    size_t _n = 0;
+    char32_t _c = 0;
+    unsigned char _lo = 0x80, _hi = 0xbf;
+    if (_b >= 0xc2 && _b <= 0xdf) { _n = 2; _c = _b & 0x1f; }
+    else if (_b >= 0xe0 && _b <= 0xef) {
+        _n = 3; _c = _b & 0x0f;
+        if (_b == 0xe0) _lo = 0xa0;
+        if (_b == 0xed) _hi = 0x9f; // surrogates
+    }
+    else if (_b >= 0xf0 && _b <= 0xf4) {
+        _n = 4; _c = _b & 0x07;
+        if (_b == 0xf0) _lo = 0x90;
+        if (_b == 0xf4) _hi = 0x8f; // > U+10FFFF
+    }
+    else return {0, 1, false};
+    for (size_t _i = 1; _i != _n; ++_i) {
+        if (_i == _s.size()) return {0, _i, false};
+        const unsigned char _x = static_cast<unsigned char>(_s[_i]);
+        if (_x < _lo || _x > _hi) return {0, _i, false};
+        _c = (_c << 6) | (_x & 0x3f);
+        _lo = 0x80; _hi = 0xbf;
+    }
+    return {_c, _n, true};
+}
+/**
+ * @brief _s 开头的 ASCII 字节数
+ * @details 有 SSE2 时每次检查 16 字节
+ */
+inline size_t ascii_prefix(std::string_view _s) {
+    size_t _i = 0;
+#ifdef __SSE2__
+    for (; _i + 16 <= _s.size(); _i += 16) {
+        const int _m = _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(_s.data() + _i)));
+        if (_m != 0) return _i + std::countr_zero(static_cast<unsigned>(_m));
+    }
+#endif
+    for (; _i != _s.size() && static_cast<unsigned char>(_s[_i]) < 0x80; ++_i);
+    return _i;
+}
+
 template <typename _Tp> auto handle(fsm::context<_Tp>& _f, char _c) {
-    if (isprint(_c)) { // printable code
-        if (isdigit(_c)) {
+    if (isprint(static_cast<unsigned char>(_c))) { // printable code
+        if (isdigit(static_cast<unsigned char>(_c))) {
             return _f.handle(digit(_c));
         }
-        if (islower(_c)) {
+        if (islower(static_cast<unsigned char>(_c))) {
             return _f.handle(lower_case(_c));
         }
-        if (isupper(_c)) {
+        if (isupper(static_cast<unsigned char>(_c))) {
             return _f.handle(upper_case(_c));
         }
         switch (_c) {
@@ -502,6 +1572,30 @@ template <typename _Tp> auto handle(fsm::context<_Tp>& _f, char _c) {
     return _f.handle(ascii_code(_c));
 }
 
+/**
+ * @brief 处理 UTF-8 编码的字符串
+ * @details ASCII 字节按 handle(context&, char) 处理；合法的多字节序列按 unicode_code（或 unicode_space）处理，
+ * 非法序列按 invalid_code 处理。连续的 ASCII 字节先整块检查，不逐字节解码。
+ * @return 处理出错前成功处理的字节数
+ */
+template <typename _Tp> size_t handle(fsm::context<_Tp>& _f, std::string_view _s) {
+    size_t _i = 0;
+    while (_i != _s.size()) {
+        for (const size_t _e = _i + ascii_prefix(_s.substr(_i)); _i != _e; ++_i) {
+            if (!handle(_f, _s[_i])) return _i;
+        }
+        if (_i == _s.size()) break;
+        const utf8_sequence _u = decode(_s.substr(_i));
+        bool _result;
+        if (!_u.valid) _result = _f.handle(invalid_code(_s[_i]));
+        else if (unicode_space::is_space(_u.code)) _result = _f.handle(unicode_space(_u.code));
+        else _result = _f.handle(unicode_code(_u.code));
+        if (!_result) return _i;
+        _i += _u.length;
+    }
+    return _i;
+}
+
 }
 
 }
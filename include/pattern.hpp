@@ -0,0 +1,361 @@
+#ifndef _ICY_PATTERN_HPP_
+#define _ICY_PATTERN_HPP_
+
+#include "finite_automaton.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace icy {
+
+namespace fsm {
+
+namespace pattern {
+
+/**
+ * @brief thrown by pattern::compile, to report syntax error in pattern
+ */
+class pattern_error : public std::logic_error {
+    using base = std::logic_error;
+    using self = pattern_error;
+public:
+    explicit pattern_error() : base("") {}
+    explicit pattern_error(const std::string& _arg) : base(_arg) {}
+    explicit pattern_error(const char* _arg) : base(_arg) {}
+    pattern_error(const self&) = default;
+    self& operator=(const self&) = default;
+    pattern_error(self&&) = default;
+    self& operator=(self&&) = default;
+    virtual ~pattern_error() override = default;
+};
+
+/**
+ * @brief 字节集合
+ */
+struct byte_set {
+    constexpr void insert(unsigned char _c) { _bits[_c >> 6] |= std::uint64_t(1) << (_c & 63); }
+    constexpr void insert(unsigned char _first, unsigned char _last) {
+        for (unsigned _c = _first; _c <= _last; ++_c) insert(static_cast<unsigned char>(_c));
+    }
+    constexpr bool contains(unsigned char _c) const { return (_bits[_c >> 6] >> (_c & 63)) & 1; }
+    constexpr void invert() { for (auto& _w : _bits) _w = ~_w; }
+    constexpr void merge(const byte_set& _s) { for (size_t _i = 0; _i != 4; ++_i) _bits[_i] |= _s._bits[_i]; }
+    std::array<std::uint64_t, 4> _bits = {};
+};
+
+/**
+ * @brief Thompson 构造得到的非确定有限自动机
+ * @details 每个状态至多有一条字节集合边，或至多两条空边
+ */
+class nfa {
+    typedef nfa self;
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+    struct node {
+        byte_set _set = {};
+        size_t _next = npos; // target of byte set edge
+        size_t _epsilon[2] = {npos, npos};
+    };
+    struct fragment {
+        size_t _start;
+        size_t _end;
+    };
+    /**
+     * @brief 解析模式串
+     * @details 支持字符、转义（\\d \\w \\s 及元字符）、字符类（[a-z] [^...]）、任意字节（.）、
+     * 量词（? * +）、选择（|）与分组（(...)）。
+     * 模式串中的 UTF-8 多字节字符作为一个整体（量词作用于整个字符），\\u 匹配任意合法的 UTF-8 多字节字符；
+     * 字符类与 . 仍按字节匹配
+     */
+    constexpr explicit nfa(std::string_view _p) : _pattern(_p) {
+        const fragment _f = _M_alternation();
+        if (_pos != _pattern.size()) {
+            throw pattern_error("unexpected ')' in pattern");
+        }
+        _start = _f._start;
+        _accept = _f._end;
+    }
+    constexpr size_t size() const { return _nodes.size(); }
+    constexpr size_t start() const { return _start; }
+    constexpr size_t accept() const { return _accept; }
+    constexpr const node& operator[](size_t _i) const { return _nodes[_i]; }
+    /**
+     * @brief 空边闭包（结果有序）
+     */
+    constexpr void closure(std::vector<size_t>& _set) const {
+        std::vector<std::uint8_t> _seen(size());
+        std::vector<size_t> _stack(_set);
+        _set.clear();
+        while (!_stack.empty()) {
+            const size_t _s = _stack.back();
+            _stack.pop_back();
+            if (_seen[_s]) continue;
+            _seen[_s] = true;
+            _set.push_back(_s);
+            for (const size_t _e : _nodes[_s]._epsilon) {
+                if (_e != npos && !_seen[_e]) _stack.push_back(_e);
+            }
+        }
+        std::sort(_set.begin(), _set.end());
+    }
+private:
+    constexpr size_t _M_node() {
+        _nodes.emplace_back();
+        return _nodes.size() - 1;
+    }
+    constexpr void _M_epsilon(size_t _from, size_t _to) {
+        node& _n = _nodes[_from];
+        assert(_n._epsilon[1] == npos);
+        _n._epsilon[_n._epsilon[0] == npos ? 0 : 1] = _to;
+    }
+    constexpr bool _M_end() const { return _pos == _pattern.size(); }
+    constexpr char _M_peek() const { return _pattern[_pos]; }
+    constexpr fragment _M_alternation() {
+        fragment _f = _M_concatenation();
+        while (!_M_end() && _M_peek() == '|') {
+            ++_pos;
+            const fragment _g = _M_concatenation();
+            const size_t _s = _M_node(), _e = _M_node();
+            _M_epsilon(_s, _f._start); _M_epsilon(_s, _g._start);
+            _M_epsilon(_f._end, _e); _M_epsilon(_g._end, _e);
+            _f = {_s, _e};
+        }
+        return _f;
+    }
+    constexpr fragment _M_concatenation() {
+        const size_t _s = _M_node();
+        fragment _f = {_s, _s};
+        while (!_M_end() && _M_peek() != '|' && _M_peek() != ')') {
+            const fragment _g = _M_repetition();
+            _M_epsilon(_f._end, _g._start);
+            _f._end = _g._end;
+        }
+        return _f;
+    }
+    constexpr fragment _M_repetition() {
+        fragment _f = _M_atom();
+        while (!_M_end() && (_M_peek() == '?' || _M_peek() == '*' || _M_peek() == '+')) {
+            const char _q = _pattern[_pos++];
+            const size_t _s = _M_node(), _e = _M_node();
+            _M_epsilon(_s, _f._start);
+            if (_q != '+') _M_epsilon(_s, _e);
+            if (_q != '?') _M_epsilon(_f._end, _f._start);
+            _M_epsilon(_f._end, _e);
+            _f = {_s, _e};
+        }
+        return _f;
+    }
+    constexpr fragment _M_atom() {
+        const char _c = _pattern[_pos++];
+        byte_set _set;
+        switch (_c) {
+            case '(': {
+                const fragment _f = _M_alternation();
+                if (_M_end() || _pattern[_pos++] != ')') {
+                    throw pattern_error("missing ')' in pattern");
+                }
+                return _f;
+            }
+            case '?': case '*': case '+':
+                throw pattern_error("quantifier without operand in pattern");
+            case '[': _set = _M_class(); break;
+            case '.': _set.invert(); break;
+            case '\\':
+                if (!_M_end() && _M_peek() == 'u') {
+                    ++_pos;
+                    return _M_utf8();
+                }
+                _set = _M_escape();
+                break;
+            default: {
+                const character::utf8_sequence _u = character::decode(_pattern.substr(_pos - 1));
+                if (_u.valid && _u.length > 1) { // multibyte character as a whole
+                    std::vector<byte_set> _seq(_u.length);
+                    for (size_t _i = 0; _i != _u.length; ++_i) {
+                        _seq[_i].insert(static_cast<unsigned char>(_pattern[_pos - 1 + _i]));
+                    }
+                    _pos += _u.length - 1;
+                    return _M_sequence(_seq);
+                }
+                _set.insert(static_cast<unsigned char>(_c));
+                break;
+            }
+        }
+        return _M_sequence({_set});
+    }
+    constexpr fragment _M_sequence(const std::vector<byte_set>& _seq) {
+        const size_t _s = _M_node();
+        size_t _e = _s;
+        for (const byte_set& _set : _seq) {
+            const size_t _n = _M_node();
+            _nodes[_e]._set = _set;
+            _nodes[_e]._next = _n;
+            _e = _n;
+        }
+        return {_s, _e};
+    }
+    /**
+     * @brief 任意合法的 UTF-8 多字节字符（Unicode 标准表 3-7）
+     */
+    constexpr fragment _M_utf8() {
+        auto _range = [](unsigned char _first, unsigned char _last) {
+            byte_set _set;
+            _set.insert(_first, _last);
+            return _set;
+        };
+        const byte_set _tail = _range(0x80, 0xbf);
+        const std::vector<std::vector<byte_set>> _alternatives = {
+            {_range(0xc2, 0xdf), _tail},
+            {_range(0xe0, 0xe0), _range(0xa0, 0xbf), _tail},
+            {_range(0xe1, 0xec), _tail, _tail},
+            {_range(0xed, 0xed), _range(0x80, 0x9f), _tail},
+            {_range(0xee, 0xef), _tail, _tail},
+            {_range(0xf0, 0xf0), _range(0x90, 0xbf), _tail, _tail},
+            {_range(0xf1, 0xf3), _tail, _tail, _tail},
+            {_range(0xf4, 0xf4), _range(0x80, 0x8f), _tail, _tail},
+        };
+        fragment _f = _M_sequence(_alternatives[0]);
+        for (size_t _i = 1; _i != _alternatives.size(); ++_i) {
+            const fragment _g = _M_sequence(_alternatives[_i]);
+            const size_t _s = _M_node(), _e = _M_node();
+            _M_epsilon(_s, _f._start); _M_epsilon(_s, _g._start);
+            _M_epsilon(_f._end, _e); _M_epsilon(_g._end, _e);
+            _f = {_s, _e};
+        }
+        return _f;
+    }
+    constexpr byte_set _M_escape() {
+        if (_M_end()) throw pattern_error("dangling '\\' in pattern");
+        const char _c = _pattern[_pos++];
+        byte_set _set;
+        switch (_c) {
+            case 'd': _set.insert('0', '9'); break;
+            case 'w': _set.insert('0', '9'); _set.insert('a', 'z'); _set.insert('A', 'Z'); _set.insert('_'); break;
+            case 's': _set.insert(' '); _set.insert('\t', '\r'); break;
+            case 'n': _set.insert('\n'); break;
+            case 't': _set.insert('\t'); break;
+            case 'r': _set.insert('\r'); break;
+            default: _set.insert(static_cast<unsigned char>(_c)); break;
+        }
+        return _set;
+    }
+    constexpr byte_set _M_class() {
+        byte_set _set;
+        const bool _negative = !_M_end() && _M_peek() == '^';
+        if (_negative) ++_pos;
+        bool _first = true;
+        while (true) {
+            if (_M_end()) throw pattern_error("missing ']' in pattern");
+            char _c = _pattern[_pos++];
+            if (_c == ']' && !_first) break;
+            _first = false;
+            if (_c == '\\') {
+                const byte_set _e = _M_escape();
+                _set.merge(_e);
+                continue;
+            }
+            if (_pos + 1 < _pattern.size() && _M_peek() == '-' && _pattern[_pos + 1] != ']') {
+                const char _last = _pattern[_pos + 1];
+                _pos += 2;
+                if (static_cast<unsigned char>(_last) < static_cast<unsigned char>(_c)) {
+                    throw pattern_error("invalid range in pattern");
+                }
+                _set.insert(static_cast<unsigned char>(_c), static_cast<unsigned char>(_last));
+                continue;
+            }
+            _set.insert(static_cast<unsigned char>(_c));
+        }
+        if (_negative) _set.invert();
+        return _set;
+    }
+private:
+    std::string_view _pattern;
+    size_t _pos = 0;
+    std::vector<node> _nodes;
+    size_t _start = npos;
+    size_t _accept = npos;
+};
+
+/**
+ * @brief 子集构造
+ * @details 只使用 std::vector，可在常量求值中使用
+ */
+constexpr dfa determinize(const nfa& _n) {
+    dfa _d;
+    std::vector<std::vector<size_t>> _sets;
+    constexpr size_t _buckets = 1024;
+    std::vector<std::vector<dfa::state_id>> _hash(_buckets);
+    auto _hash_of = [](const std::vector<size_t>& _s) {
+        size_t _h = 14695981039346656037ull;
+        for (const size_t _x : _s) { _h ^= _x; _h *= 1099511628211ull; }
+        return _h % _buckets;
+    };
+    auto _id_of = [&](std::vector<size_t>&& _s) -> dfa::state_id {
+        auto& _bucket = _hash[_hash_of(_s)];
+        for (const dfa::state_id _i : _bucket) {
+            if (_sets[_i] == _s) return _i;
+        }
+        const bool _accepting = std::binary_search(_s.cbegin(), _s.cend(), _n.accept());
+        const dfa::state_id _i = _d.add_state(_accepting);
+        _bucket.push_back(_i);
+        _sets.push_back(std::move(_s));
+        return _i;
+    };
+    std::vector<size_t> _init = {_n.start()};
+    _n.closure(_init);
+    _d.entry(_id_of(std::move(_init)));
+    std::array<std::vector<size_t>, dfa::alphabet_size> _moves;
+    for (size_t _i = 0; _i != _sets.size(); ++_i) {
+        for (auto& _m : _moves) _m.clear();
+        for (const size_t _s : _sets[_i]) {
+            const auto& _node = _n[_s];
+            if (_node._next == nfa::npos) continue;
+            for (size_t _b = 0; _b != dfa::alphabet_size; ++_b) {
+                if (_node._set.contains(static_cast<unsigned char>(_b))) {
+                    _moves[_b].push_back(_node._next);
+                }
+            }
+        }
+        std::vector<std::pair<size_t, dfa::state_id>> _done; // representative byte, target
+        for (size_t _b = 0; _b != dfa::alphabet_size; ++_b) {
+            if (_moves[_b].empty()) continue;
+            dfa::state_id _t = dfa::npos;
+            for (const auto& [_p, _q] : _done) { // bytes with the same move share the closure
+                if (_moves[_p] == _moves[_b]) { _t = _q; break; }
+            }
+            if (_t == dfa::npos) {
+                std::vector<size_t> _m = _moves[_b];
+                _n.closure(_m);
+                _t = _id_of(std::move(_m));
+                _done.emplace_back(_b, _t);
+            }
+            _d.link(static_cast<dfa::state_id>(_i), static_cast<unsigned char>(_b), _t);
+        }
+    }
+    return _d;
+}
+
+/**
+ * @brief 将模式串编译为最小化的确定有限自动机
+ * @details 匹配语义与 dfa::match 一致：从头处理输入直到无法转移
+ * @throw pattern_error 模式串语法错误
+ */
+constexpr dfa compile(std::string_view _p) {
+    dfa _d = determinize(nfa(_p));
+    _d.minimize();
+    return _d;
+}
+
+}
+
+}
+
+}
+
+#endif // _ICY_PATTERN_HPP_
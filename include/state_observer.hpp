@@ -0,0 +1,137 @@
+#ifndef _ICY_STATE_OBSERVER_HPP_
+#define _ICY_STATE_OBSERVER_HPP_
+
+#include "finite_state_machine.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <array>
+#include <atomic>
+#include <type_traits>
+#include <variant>
+
+namespace icy {
+
+namespace fsm {
+
+/**
+ * @brief 顺序锁：单个写线程，任意多个读线程
+ * @details 写线程从不等待；读线程不加锁，读到写了一半的数据时重试。数据按机器字以 relaxed 原子操作复制，没有数据竞争。
+ * @tparam _Tp 可平凡复制的数据类型
+ */
+template <typename _Tp> requires std::is_trivially_copyable<_Tp>::value class seqlock {
+    typedef seqlock self;
+public:
+    seqlock() { store(_Tp()); }
+    explicit seqlock(const _Tp& _v) { store(_v); }
+    seqlock(const self&) = delete;
+    self& operator=(const self&) = delete;
+    ~seqlock() = default;
+public:
+    /**
+     * @brief 写入（只能由一个线程调用）
+     */
+    void store(const _Tp& _v) {
+        std::array<std::uint64_t, words> _b = {};
+        std::memcpy(_b.data(), &_v, sizeof(_Tp));
+        const std::uint64_t _s = _seq.load(std::memory_order_relaxed);
+        _seq.store(_s + 1, std::memory_order_relaxed); // odd: writing
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t _i = 0; _i != words; ++_i) {
+            _data[_i].store(_b[_i], std::memory_order_relaxed);
+        }
+        _seq.store(_s + 2, std::memory_order_release);
+    }
+    /**
+     * @brief 尝试读取一次，不等待
+     * @return 是否读到一致的数据（写线程正在写入时失败）
+     */
+    bool try_load(_Tp& _v) const {
+        const std::uint64_t _s = _seq.load(std::memory_order_acquire);
+        if (_s & 1) return false;
+        std::array<std::uint64_t, words> _b;
+        for (size_t _i = 0; _i != words; ++_i) {
+            _b[_i] = _data[_i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (_seq.load(std::memory_order_relaxed) != _s) return false;
+        std::memcpy(static_cast<void*>(&_v), _b.data(), sizeof(_Tp));
+        return true;
+    }
+    /**
+     * @brief 读取，直到读到一致的数据
+     */
+    _Tp load() const {
+        _Tp _v;
+        while (!try_load(_v));
+        return _v;
+    }
+    /**
+     * @brief 写入次数
+     */
+    std::uint64_t version() const { return _seq.load(std::memory_order_acquire) / 2; }
+private:
+    static constexpr size_t words = (sizeof(_Tp) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+    alignas(64) std::atomic<std::uint64_t> _seq = 0;
+    std::array<std::atomic<std::uint64_t>, words> _data;
+};
+
+/**
+ * @brief 状态机的快照
+ * @tparam _Dt 状态数据摘要（可平凡复制）
+ */
+template <typename _Dt = std::monostate> struct snapshot {
+    state::label_type label = {}; // points to static storage
+    bool acceptable = false;
+    std::uint64_t updates = 0; // publications since observed
+    _Dt data = {};
+};
+
+/**
+ * @brief 通过顺序锁发布状态机的当前状态
+ *
+ * @details 用 context::observe 挂载，驱动状态机的线程在每次状态切换结束时写入快照，
+ * 监控线程随时调用 load / try_load 读取一致的（状态, 是否可接受, 发布次数, 数据摘要），不会阻塞写线程。
+ * @tparam _Bs 有限状态类型
+ * @tparam _Dt 状态数据摘要，由构造时给出的函数从当前状态中提取
+ */
+template <basic_state _Bs, typename _Dt = std::monostate> class state_observer : public observer {
+    typedef state_observer self;
+public:
+    typedef fsm::snapshot<_Dt> snapshot_type;
+    typedef _Dt (*summary_type)(const _Bs&);
+    explicit state_observer(summary_type _summary = nullptr) : _summary(_summary) {}
+    state_observer(const self&) = delete;
+    self& operator=(const self&) = delete;
+    virtual ~state_observer() override = default;
+public:
+    void publish(const state* _s, state::label_type _label, bool _acceptable) override {
+        _last.label = _label;
+        _last.acceptable = _acceptable;
+        ++_last.updates;
+        if (_summary != nullptr && _s != nullptr) {
+            _last.data = _summary(static_cast<const _Bs&>(*_s));
+        }
+        _lock.store(_last);
+    }
+    /**
+     * @brief 读取最近发布的快照（可能重试，不加锁）
+     */
+    snapshot_type load() const { return _lock.load(); }
+    /**
+     * @brief 尝试读取一次，写线程正在写入时返回 false
+     */
+    bool try_load(snapshot_type& _v) const { return _lock.try_load(_v); }
+private:
+    summary_type _summary;
+    snapshot_type _last; // writer's copy
+    seqlock<snapshot_type> _lock;
+};
+
+}
+
+}
+
+#endif // _ICY_STATE_OBSERVER_HPP_
@@ -0,0 +1,118 @@
+#ifndef _ICY_STATIC_AUTOMATON_HPP_
+#define _ICY_STATIC_AUTOMATON_HPP_
+
+#include "pattern.hpp"
+
+#include <cstddef>
+
+#include <array>
+#include <concepts>
+#include <string_view>
+#include <utility>
+
+namespace icy {
+
+namespace fsm {
+
+/**
+ * @brief 定长的确定有限自动机
+ * @details 转移表保存在 std::array 中，可以作为 constexpr 变量，在常量求值中匹配。匹配语义与 dfa::match 一致。
+ * @tparam _N 状态数
+ * @tparam _K 字节类数
+ */
+template <size_t _N, size_t _K> struct static_dfa {
+    typedef dfa::state_id state_id;
+    typedef dfa::class_id class_id;
+    static constexpr size_t states = _N;
+    static constexpr size_t classes = _K;
+    constexpr static_dfa() = default;
+    constexpr explicit static_dfa(const dfa& _d) : entry(_d.entry()) {
+        assert(_d.size() == _N && _d.classes() == _K);
+        std::array<unsigned char, _K> _repr = {}; // one byte of each class
+        for (size_t _b = 0; _b != dfa::alphabet_size; ++_b) {
+            classes_of[_b] = _d.classify(static_cast<unsigned char>(_b));
+            _repr[classes_of[_b]] = static_cast<unsigned char>(_b);
+        }
+        for (size_t _s = 0; _s != _N; ++_s) {
+            const state_id _q = static_cast<state_id>(_s);
+            for (size_t _c = 0; _c != _K; ++_c) {
+                table[_s * _K + _c] = _d.next(_q, _repr[_c]);
+            }
+            fates[_s] = _d.fate_of(_q);
+            accepting[_s] = _d.acceptable(_q);
+        }
+    }
+    /**
+     * @brief 从初始状态开始处理字符串，直到输入结束或无法转移
+     */
+    constexpr dfa::result match(std::string_view _s) const {
+        if (entry == dfa::npos) return {};
+        state_id _q = entry;
+        size_t _i = 0;
+        for (; _i != _s.size(); ++_i) {
+            if (fates[_q] != dfa::fate::open) break;
+            const state_id _n = table[_q * _K + classes_of[static_cast<unsigned char>(_s[_i])]];
+            if (_n == dfa::npos) break;
+            _q = _n;
+        }
+        if (fates[_q] == dfa::fate::absorbing) return {true, _s.size()};
+        return {accepting[_q], _i};
+    }
+    /**
+     * @brief 整个字符串是否可被接受
+     */
+    constexpr bool recognize(std::string_view _s) const {
+        const dfa::result _r = match(_s);
+        return _r.accepted && _r.length == _s.size();
+    }
+    std::array<class_id, dfa::alphabet_size> classes_of = {};
+    std::array<state_id, _N * _K> table = {};
+    std::array<dfa::fate, _N> fates = {};
+    std::array<bool, _N> accepting = {};
+    state_id entry = dfa::npos;
+};
+
+/**
+ * @brief 由模式串定义的状态机
+ * @details 例如 <tt>struct float_machine { static constexpr std::string_view pattern = "[0-9]+(\\.[0-9]+)?"; };</tt>
+ */
+template <typename _Mt> concept pattern_machine = requires {
+    {_Mt::pattern} -> std::convertible_to<std::string_view>;
+};
+
+namespace {
+
+template <pattern_machine _Mt> constexpr auto _S_static_dfa() {
+    constexpr std::pair<size_t, size_t> _dims = [] {
+        const dfa _d = pattern::compile(_Mt::pattern);
+        return std::pair<size_t, size_t>(_d.size(), _d.classes());
+    }();
+    return static_dfa<_dims.first, _dims.second>(pattern::compile(_Mt::pattern));
+}
+
+}
+
+/**
+ * @brief 编译期编译得到的自动机
+ */
+template <pattern_machine _Mt> inline constexpr auto static_machine = _S_static_dfa<_Mt>();
+
+/**
+ * @brief 在编译期（或运行期）识别字符串：整个字符串是否可被状态机 _Mt 接受
+ * @details 例如 <tt>static_assert(fsm::recognize<float_machine>("-2.3e-3"));</tt>
+ */
+template <pattern_machine _Mt> constexpr bool recognize(std::string_view _s) {
+    return static_machine<_Mt>.recognize(_s);
+}
+/**
+ * @brief 在编译期（或运行期）匹配字符串，语义与 dfa::match 一致
+ */
+template <pattern_machine _Mt> constexpr dfa::result match(std::string_view _s) {
+    return static_machine<_Mt>.match(_s);
+}
+
+}
+
+}
+
+#endif // _ICY_STATIC_AUTOMATON_HPP_
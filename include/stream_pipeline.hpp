@@ -0,0 +1,333 @@
+#ifndef _ICY_STREAM_PIPELINE_HPP_
+#define _ICY_STREAM_PIPELINE_HPP_
+
+#include "finite_state_machine.hpp"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string_view>
+#include <thread>
+
+#include <poll.h>
+#include <unistd.h>
+
+#if defined(ICY_FSM_IO_URING) && __has_include(<liburing.h>)
+#include <liburing.h>
+#define _ICY_FSM_IO_URING_ 1
+#endif
+
+namespace icy {
+
+namespace fsm {
+
+/**
+ * @brief 无锁的单生产者单消费者环形队列
+ * @details 生产者与消费者的下标位于不同的缓存行，并各自缓存对方的下标，只在看起来满（空）时重新读取。
+ * push、pop 在队列满（空）时阻塞在对方的下标上（std::atomic::wait），而不是轮询
+ * @tparam _N 容量（2 的幂）
+ */
+template <typename _Tp, size_t _N> class spsc_ring {
+    static_assert(_N != 0 && (_N & (_N - 1)) == 0, "capacity of spsc_ring must be a power of 2");
+    typedef spsc_ring self;
+public:
+    spsc_ring() = default;
+    spsc_ring(const self&) = delete;
+    self& operator=(const self&) = delete;
+    ~spsc_ring() = default;
+public:
+    static constexpr size_t capacity() { return _N; }
+    /**
+     * @brief 入队（只能由生产者调用）
+     * @return 队列满时返回 false
+     */
+    bool try_push(const _Tp& _v) {
+        const size_t _t = _tail.load(std::memory_order_relaxed);
+        if (_t - _head_cache == _N) {
+            _head_cache = _head.load(std::memory_order_acquire);
+            if (_t - _head_cache == _N) return false;
+        }
+        _items[_t & (_N - 1)] = _v;
+        _tail.store(_t + 1, std::memory_order_release);
+        _tail.notify_one();
+        return true;
+    }
+    /**
+     * @brief 出队（只能由消费者调用）
+     * @return 队列空时返回 false
+     */
+    bool try_pop(_Tp& _v) {
+        const size_t _h = _head.load(std::memory_order_relaxed);
+        if (_h == _tail_cache) {
+            _tail_cache = _tail.load(std::memory_order_acquire);
+            if (_h == _tail_cache) return false;
+        }
+        _v = _items[_h & (_N - 1)];
+        _head.store(_h + 1, std::memory_order_release);
+        _head.notify_one();
+        return true;
+    }
+    /**
+     * @brief 入队，队列满时等待消费者出队（只能由生产者调用）
+     */
+    void push(const _Tp& _v) {
+        while (!try_push(_v)) _head.wait(_head_cache, std::memory_order_acquire);
+    }
+    /**
+     * @brief 出队，队列空时等待生产者入队（只能由消费者调用）
+     */
+    void pop(_Tp& _v) {
+        while (!try_pop(_v)) _tail.wait(_tail_cache, std::memory_order_acquire);
+    }
+private:
+    alignas(64) std::atomic<size_t> _head = 0; // written by the consumer
+    size_t _tail_cache = 0;
+    alignas(64) std::atomic<size_t> _tail = 0; // written by the producer
+    size_t _head_cache = 0;
+    alignas(64) std::array<_Tp, _N> _items = {};
+};
+
+/**
+ * @brief 流水线中一个阶段的统计
+ */
+struct stage_report {
+    double busy = 0; // seconds spent reading or parsing
+    double idle = 0; // seconds spent waiting for the other stage
+    size_t bytes = 0;
+    size_t chunks = 0;
+    double utilisation() const { return busy + idle > 0 ? busy / (busy + idle) : 0; }
+};
+/**
+ * @brief 流水线的统计
+ */
+struct pipeline_report {
+    stage_report reader;
+    stage_report parser;
+    double seconds = 0;
+    int error = 0; // errno of the failed read, 0 if none
+    bool stopped = false; // stopped by the parser
+    double throughput() const { return seconds > 0 ? parser.bytes / seconds : 0; } // bytes per second
+};
+
+/**
+ * @brief 读取 → 解析 两级流水线
+ *
+ * @details 读线程把文件描述符中的数据读入 _Depth 个固定大小、循环使用的缓冲区，经无锁的单生产者单消费者队列交给解析线程
+ * （调用 run 的线程）。缓冲区用完后经另一个队列还给读线程，运行时不分配内存。
+ * 两个线程在队列空时阻塞等待，读线程在 poll 中同时等待数据与停止通知。
+ * 定义 ICY_FSM_IO_URING 且有 liburing 时读线程使用 io_uring，否则使用 read。
+ * @tparam _Chunk 缓冲区大小
+ * @tparam _Depth 缓冲区数量（2 的幂）
+ */
+template <size_t _Chunk = 64 * 1024, size_t _Depth = 8> class stream_pipeline {
+    typedef stream_pipeline self;
+public:
+    stream_pipeline() : _memory(std::make_unique<char[]>(_Chunk * _Depth)) {}
+    stream_pipeline(const self&) = delete;
+    self& operator=(const self&) = delete;
+    ~stream_pipeline() = default;
+public:
+    /**
+     * @brief 读取 _fd 直到文件结束、读取出错或 _feed 返回 false
+     * @param _feed 按顺序处理每个数据块 <tt>bool(std::string_view)</tt>，状态由调用者跨块保存（例如 character::feeder）
+     * @details 解析线程提前停止时经管道通知读线程，正在等待数据的读线程立即结束，不再发起新的 read
+     */
+    template <typename _Fn> pipeline_report run(int _fd, _Fn&& _feed) {
+        typedef std::chrono::steady_clock clock;
+        pipeline_report _r;
+        if (::pipe(_wake) != 0) {
+            _r.error = errno;
+            return _r;
+        }
+        _stop.store(false, std::memory_order_relaxed);
+        for (std::uint32_t _i = 0; _i != _Depth; ++_i) {
+            _free.try_push({_i, 0});
+        }
+        const clock::time_point _begin = clock::now();
+        std::thread _reader([this, _fd, &_r]() { _M_read(_fd, _r); });
+        slot _s;
+        for (;;) {
+            const clock::time_point _a = clock::now();
+            _full.pop(_s);
+            const clock::time_point _b = clock::now();
+            _r.parser.idle += std::chrono::duration<double>(_b - _a).count();
+            if (_s._size == 0) break;
+            const bool _go = _feed(std::string_view(_M_buffer(_s._index), _s._size));
+            _r.parser.busy += std::chrono::duration<double>(clock::now() - _b).count();
+            _r.parser.bytes += _s._size;
+            ++_r.parser.chunks;
+            if (!_go) {
+                _r.stopped = true;
+                _stop.store(true, std::memory_order_relaxed);
+                const char _c = 0;
+                while (::write(_wake[1], &_c, 1) < 0 && errno == EINTR); // wakes a reader in poll
+            }
+            _free.try_push({_s._index, 0}); // never full; wakes a reader waiting for a buffer
+            if (!_go) break;
+        }
+        _reader.join();
+        _r.seconds = std::chrono::duration<double>(clock::now() - _begin).count();
+        while (_full.try_pop(_s)); // left by a stopped parser
+        while (_free.try_pop(_s));
+        ::close(_wake[0]);
+        ::close(_wake[1]);
+        return _r;
+    }
+private:
+    struct slot {
+        std::uint32_t _index;
+        std::uint32_t _size; // 0: end of stream
+    };
+    char* _M_buffer(std::uint32_t _i) { return _memory.get() + static_cast<size_t>(_i) * _Chunk; }
+    void _M_read(int _fd, pipeline_report& _r) {
+        typedef std::chrono::steady_clock clock;
+#ifdef _ICY_FSM_IO_URING_
+        io_uring _ring;
+        const bool _uring = io_uring_queue_init(1, &_ring, 0) == 0;
+#endif
+        slot _s;
+        for (;;) {
+            const clock::time_point _a = clock::now();
+            _free.pop(_s);
+            if (_stop.load(std::memory_order_relaxed)) break; // no further read once the parser has stopped
+            const int _ready = _M_wait(_fd);
+            const clock::time_point _b = clock::now();
+            _r.reader.idle += std::chrono::duration<double>(_b - _a).count();
+            if (_ready == 0) break; // stopped while waiting for data
+            ssize_t _n = -1; // errno set by poll
+            if (_ready > 0) {
+#ifdef _ICY_FSM_IO_URING_
+                if (_uring) _n = _M_read_uring(_ring, _fd, _M_buffer(_s._index));
+                else
+#endif
+                do {
+                    _n = ::read(_fd, _M_buffer(_s._index), _Chunk);
+                } while (_n < 0 && errno == EINTR);
+            }
+            _r.reader.busy += std::chrono::duration<double>(clock::now() - _b).count();
+            if (_n < 0) {
+                _r.error = errno;
+                _n = 0;
+            }
+            _s._size = static_cast<std::uint32_t>(_n);
+            _r.reader.bytes += _s._size;
+            _r.reader.chunks += (_n != 0);
+            _full.try_push(_s); // never full
+            if (_n == 0) break;
+        }
+#ifdef _ICY_FSM_IO_URING_
+        if (_uring) io_uring_queue_exit(&_ring);
+#endif
+    }
+    /**
+     * @brief 等待 _fd 可读或解析线程停止
+     * @return 1：可读（或已挂断、出错，由 read 报告），0：已停止，-1：poll 出错
+     */
+    int _M_wait(int _fd) {
+        pollfd _p[2] = {{_fd, POLLIN, 0}, {_wake[0], POLLIN, 0}};
+        int _e;
+        while ((_e = ::poll(_p, 2, -1)) < 0 && errno == EINTR);
+        if (_e < 0) return -1;
+        return _p[1].revents != 0 ? 0 : 1;
+    }
+#ifdef _ICY_FSM_IO_URING_
+    ssize_t _M_read_uring(io_uring& _ring, int _fd, char* _buffer) {
+        io_uring_sqe* const _sqe = io_uring_get_sqe(&_ring);
+        io_uring_prep_read(_sqe, _fd, _buffer, _Chunk, static_cast<__u64>(-1)); // current file position
+        io_uring_submit(&_ring);
+        io_uring_cqe* _cqe;
+        int _e;
+        while ((_e = io_uring_wait_cqe(&_ring, &_cqe)) == -EINTR);
+        if (_e < 0) { errno = -_e; return -1; }
+        const int _res = _cqe->res;
+        io_uring_cqe_seen(&_ring, _cqe);
+        if (_res < 0) { errno = -_res; return -1; }
+        return _res;
+    }
+#endif
+private:
+    std::unique_ptr<char[]> _memory;
+    spsc_ring<slot, _Depth> _full; // reader -> parser
+    spsc_ring<slot, _Depth> _free; // parser -> reader
+    std::atomic<bool> _stop = false;
+    int _wake[2] = {-1, -1}; // written by the parser when it stops
+};
+
+namespace character {
+
+/**
+ * @brief 分块处理 UTF-8 字符串
+ * @details 块末尾不完整的多字节序列保留到下一块，与下一块开头的后续字节拼接后处理，结果与整体调用 handle(context&, std::string_view) 相同
+ */
+template <typename _Tp> class feeder {
+    typedef feeder self;
+public:
+    explicit feeder(fsm::context<_Tp>& _f) : _f(_f) {}
+    feeder(const self&) = delete;
+    self& operator=(const self&) = delete;
+    ~feeder() = default;
+public:
+    /**
+     * @return 是否处理正常
+     */
+    bool feed(std::string_view _s) {
+        if (_size != 0) { // complete the pending sequence
+            while (_size != _need && !_s.empty() && (static_cast<unsigned char>(_s[0]) & 0xc0) == 0x80) {
+                _pending[_size++] = _s[0];
+                _s.remove_prefix(1);
+            }
+            if (_size != _need && _s.empty()) return true;
+            const std::string_view _p(_pending.data(), _size);
+            _size = 0;
+            if (handle(_f, _p) != _p.size()) return false;
+        }
+        const size_t _k = _M_tail(_s);
+        const std::string_view _body = _s.substr(0, _s.size() - _k);
+        if (handle(_f, _body) != _body.size()) return false;
+        for (size_t _i = _body.size(); _i != _s.size(); ++_i) {
+            _pending[_size++] = _s[_i];
+        }
+        return true;
+    }
+    /**
+     * @brief 输入结束，处理保留的不完整序列
+     */
+    bool finish() {
+        const std::string_view _p(_pending.data(), _size);
+        _size = 0;
+        return handle(_f, _p) == _p.size();
+    }
+private:
+    /**
+     * @brief 末尾不完整的多字节序列的长度
+     */
+    size_t _M_tail(std::string_view _s) {
+        for (size_t _k = 1; _k <= 3 && _k <= _s.size(); ++_k) {
+            const unsigned char _b = static_cast<unsigned char>(_s[_s.size() - _k]);
+            if ((_b & 0xc0) == 0x80) continue;
+            const size_t _n = (_b >= 0xf0 ? 4 : _b >= 0xe0 ? 3 : _b >= 0xc0 ? 2 : 1);
+            if (_n <= _k) return 0;
+            _need = _n;
+            return _k;
+        }
+        return 0;
+    }
+private:
+    fsm::context<_Tp>& _f;
+    std::array<char, 4> _pending = {};
+    size_t _size = 0;
+    size_t _need = 0;
+};
+
+}
+
+}
+
+}
+
+#endif // _ICY_STREAM_PIPELINE_HPP_
@@ -0,0 +1,212 @@
+#ifndef _ICY_SYMBOL_TOKEN_HPP_
+#define _ICY_SYMBOL_TOKEN_HPP_
+
+#include "finite_state_machine.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+#include <array>
+#include <stdexcept>
+#include <string_view>
+
+namespace icy {
+
+namespace fsm {
+
+namespace character {
+
+/**
+ * @brief 符号前缀树
+ * @details 由 "name symbol" 列表（每行一项，与 doc/symbol.txt 格式相同，忽略空行）在编译期构造，
+ * 首字节查表，其后沿兄弟链查找。不分配内存，列表须比前缀树存活得更久。
+ * @tparam _N 结点数上限
+ */
+template <size_t _N = 128> class symbol_trie {
+    typedef symbol_trie self;
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+    struct token {
+        size_t index = npos; // npos: no symbol
+        size_t length = 0;
+    };
+    /**
+     * @throw std::invalid_argument 列表格式错误或符号重复
+     * @throw std::length_error 结点数超过 _N
+     */
+    constexpr explicit symbol_trie(std::string_view _list) {
+        _first.fill(none);
+        while (!_list.empty()) {
+            const size_t _eol = _list.find('\n');
+            std::string_view _line = _list.substr(0, _eol);
+            _list.remove_prefix(_eol == std::string_view::npos ? _list.size() : _eol + 1);
+            if (!_line.empty() && _line.back() == '\r') _line.remove_suffix(1);
+            if (_line.empty()) continue;
+            const size_t _space = _line.find(' ');
+            if (_space == 0 || _space == std::string_view::npos || _space + 1 == _line.size()) {
+                throw std::invalid_argument("malformed line in symbol list");
+            }
+            _M_insert(_line.substr(0, _space), _line.substr(_space + 1));
+        }
+    }
+    constexpr symbol_trie(const self&) = default;
+    constexpr self& operator=(const self&) = default;
+public:
+    /**
+     * @brief 符号数
+     */
+    constexpr size_t size() const { return _size; }
+    constexpr std::string_view name(size_t _i) const { return _names[_i]; }
+    constexpr std::string_view symbol(size_t _i) const { return _symbols[_i]; }
+    /**
+     * @brief 最长符号的长度，即最长匹配需要的前瞻字节数
+     */
+    constexpr size_t lookahead() const { return _lookahead; }
+    /**
+     * @brief 按名字查找符号
+     */
+    constexpr size_t find(std::string_view _name) const {
+        for (size_t _i = 0; _i != _size; ++_i) {
+            if (_names[_i] == _name) return _i;
+        }
+        return npos;
+    }
+    /**
+     * @brief 最长匹配：_s 开头的最长符号
+     */
+    constexpr token match(std::string_view _s) const {
+        token _t;
+        if (_s.empty()) return _t;
+        std::uint16_t _n = _first[static_cast<unsigned char>(_s[0])];
+        for (size_t _i = 1; _n != none; ++_i) {
+            if (_nodes[_n]._symbol != none) _t = {_nodes[_n]._symbol, _i};
+            if (_i == _s.size()) break;
+            _n = _M_child(_n, _s[_i]);
+        }
+        return _t;
+    }
+private:
+    static constexpr std::uint16_t none = 0xffff;
+    struct node {
+        char _byte = 0;
+        std::uint16_t _child = none;
+        std::uint16_t _sibling = none;
+        std::uint16_t _symbol = none;
+    };
+    constexpr std::uint16_t _M_child(std::uint16_t _n, char _c) const {
+        std::uint16_t _x = _nodes[_n]._child;
+        while (_x != none && _nodes[_x]._byte != _c) _x = _nodes[_x]._sibling;
+        return _x;
+    }
+    constexpr std::uint16_t _M_node(char _c) {
+        if (_count == _N) throw std::length_error("too many nodes in symbol_trie");
+        _nodes[_count]._byte = _c;
+        return static_cast<std::uint16_t>(_count++);
+    }
+    constexpr void _M_insert(std::string_view _name, std::string_view _symbol) {
+        if (_size == _N || find(_name) != npos) throw std::invalid_argument("duplicate name in symbol list");
+        std::uint16_t& _head = _first[static_cast<unsigned char>(_symbol[0])];
+        if (_head == none) _head = _M_node(_symbol[0]);
+        std::uint16_t _n = _head;
+        for (size_t _i = 1; _i != _symbol.size(); ++_i) {
+            std::uint16_t _x = _M_child(_n, _symbol[_i]);
+            if (_x == none) {
+                _x = _M_node(_symbol[_i]);
+                _nodes[_x]._sibling = _nodes[_n]._child;
+                _nodes[_n]._child = _x;
+            }
+            _n = _x;
+        }
+        if (_nodes[_n]._symbol != none) throw std::invalid_argument("duplicate symbol in symbol list");
+        _nodes[_n]._symbol = static_cast<std::uint16_t>(_size);
+        _names[_size] = _name;
+        _symbols[_size] = _symbol;
+        ++_size;
+        _lookahead = (_symbol.size() > _lookahead ? _symbol.size() : _lookahead);
+    }
+private:
+    std::array<std::uint16_t, 256> _first = {}; // first byte -> node
+    std::array<node, _N> _nodes = {};
+    std::array<std::string_view, _N> _names = {};
+    std::array<std::string_view, _N> _symbols = {};
+    size_t _count = 0;
+    size_t _size = 0;
+    size_t _lookahead = 0;
+};
+
+/**
+ * @brief 按最长匹配切分字符串
+ * @details 开头能匹配 _t 中的符号时调用 _symbol(下标, 符号)，否则调用 _byte(字节)；回调返回 false 表示出错
+ * @return 处理出错前成功处理的字节数
+ */
+template <size_t _N, typename _Sf, typename _Bf>
+constexpr size_t munch(const symbol_trie<_N>& _t, std::string_view _s, _Sf&& _symbol, _Bf&& _byte) {
+    size_t _i = 0;
+    while (_i != _s.size()) {
+        const auto _k = _t.match(_s.substr(_i, _t.lookahead()));
+        if (_k.index != symbol_trie<_N>::npos) {
+            if (!_symbol(_k.index, _s.substr(_i, _k.length))) return _i;
+            _i += _k.length;
+        }
+        else {
+            if (!_byte(_s[_i])) return _i;
+            ++_i;
+        }
+    }
+    return _i;
+}
+
+/**
+ * @brief 多字节运算符
+ */
+struct operator_code : public fsm::event {
+    constexpr operator_code(std::string_view _s): _val(_s) {}
+    inline constexpr std::string_view value() const { return _val; }
+private:
+    const std::string_view _val;
+};
+struct increment : public operator_code { // ++
+    increment() : operator_code("++") {}
+};
+struct decrement : public operator_code { // --
+    decrement() : operator_code("--") {}
+};
+struct arrow : public operator_code { // ->
+    arrow() : operator_code("->") {}
+};
+
+/**
+ * @brief 多字节运算符列表（doc/symbol.txt 中的多字节符号）
+ */
+inline constexpr std::string_view operator_symbols =
+    "increment ++\n"
+    "decrement --\n"
+    "arrow ->\n";
+inline constexpr symbol_trie<8> operators(operator_symbols);
+static_assert(operators.find("increment") == 0 && operators.find("decrement") == 1 && operators.find("arrow") == 2);
+
+/**
+ * @brief 处理 ASCII 字符串，多字节运算符按最长匹配作为一个事件处理
+ * @details 例如 "a-->b" 依次处理 lower_case('a')、decrement、right_angle、lower_case('b')；其余字节按 handle(context&, char) 处理
+ * @return 处理出错前成功处理的字节数
+ */
+template <typename _Tp> size_t handle_operators(fsm::context<_Tp>& _f, std::string_view _s) {
+    return munch(operators, _s,
+        [&_f](size_t _i, std::string_view) {
+            switch (_i) {
+                case 0: return _f.handle(increment());
+                case 1: return _f.handle(decrement());
+                default: return _f.handle(arrow());
+            }
+        },
+        [&_f](char _c) { return handle(_f, _c); }
+    );
+}
+
+}
+
+}
+
+}
+
+#endif // _ICY_SYMBOL_TOKEN_HPP_
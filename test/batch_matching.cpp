@@ -0,0 +1,42 @@
+#include "pattern.hpp"
+
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace icy;
+
+int main() {
+    const auto _float = fsm::pattern::compile("[+-]?[0-9]+(\\.[0-9]+)?(e[+-]?[0-9]+)?");
+    const auto _empty = fsm::pattern::compile("");
+    std::mt19937 _random(7);
+    const std::string _alphabet = "0123456789+-.e x";
+    std::vector<std::string> _cells;
+    for (size_t _i = 0; _i != 5000; ++_i) {
+        std::string _s(_random() % 12, '0');
+        for (auto& _c : _s) _c = _alphabet[_random() % _alphabet.size()];
+        _cells.push_back(std::move(_s));
+    }
+    _cells.push_back("-12.5e+3");
+    _cells.push_back(std::string(1000, '7'));
+    _cells.push_back("1" + std::string(1000, 'x'));
+    std::vector<std::string_view> _views(_cells.cbegin(), _cells.cend());
+
+    for (const size_t _n : {size_t(0), size_t(1), size_t(5), size_t(63), _views.size()}) {
+        const std::span<const std::string_view> _batch(_views.data() + _views.size() - _n, _n);
+        for (const auto* _d : {&_float, &_empty}) {
+            const auto _r = _d->match(_batch);
+            assert(_r.size() == _n);
+            for (size_t _i = 0; _i != _n; ++_i) {
+                const auto _e = _d->match(_batch[_i]);
+                assert(_r[_i].accepted == _e.accepted && _r[_i].length == _e.length);
+            }
+        }
+    }
+    const auto _r = _float.match(std::span<const std::string_view>(_views.data() + _views.size() - 3, 3));
+    assert(_r[0].accepted && _r[0].length == 8);
+    assert(_r[1].accepted && _r[1].length == 1000);
+    assert(_r[2].accepted && _r[2].length == 1);
+    assert(fsm::dfa().match(std::span<const std::string_view>(_views))[0].length == 0);
+    return 0;
+}
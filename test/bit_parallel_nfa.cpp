@@ -0,0 +1,64 @@
+#include "bit_parallel.hpp"
+
+#include <string>
+#include <vector>
+
+using namespace icy;
+
+int main() {
+    const std::vector<std::string_view> _patterns = {
+        "[+-]?[0-9]+(\\.[0-9]+)?(e[+-]?[0-9]+)?", "[a-zA-Z_]\\w*", "if|else|el(if)?", "/\\*([^*]|\\*+[^*/])*\\*+/", "", "a.*"
+    };
+    const std::vector<std::string> _inputs = {
+        "", "1", "-0.123e2.13", "+10.1e.123e2.13", "_foo42+", "4foo", "elif", "els", "/* a */ b */", "abc", std::string("a\0\xff", 3)
+    };
+    const fsm::bit_nfa<> _all(_patterns);
+    assert(_all.size() == _patterns.size());
+    for (size_t _j = 0; _j != _patterns.size(); ++_j) {
+        const auto _d = fsm::pattern::compile(_patterns[_j]);
+        const fsm::bit_nfa<> _one(_patterns[_j]);
+        for (const auto& _s : _inputs) {
+            const auto _r = _d.match(_s);
+            const auto _a = _all.match(_s)[_j];
+            const auto _o = _one.match(_s)[0];
+            assert(_a.accepted == _r.accepted && _a.length == _r.length);
+            assert(_o.accepted == _r.accepted && _o.length == _r.length);
+        }
+    }
+
+    // the n-th byte from the end is 'a': 2^n dfa states, n + 2 nfa states
+    std::string _tail = "[ab]*a";
+    for (size_t _i = 0; _i != 40; ++_i) _tail += "[ab]";
+    const fsm::bit_nfa<> _nfa(_tail);
+    assert(_nfa.states() == 43);
+    std::string _s(100, 'b');
+    _s[100 - 41] = 'a';
+    assert(_nfa.match(_s)[0].accepted && _nfa.match(_s)[0].length == 100);
+    _s[100 - 41] = 'b';
+    assert(!_nfa.match(_s)[0].accepted && _nfa.match(_s)[0].length == 100);
+    assert(_nfa.match(_s + "c")[0].length == 100);
+
+    // more states than a machine word
+    bool _thrown = false;
+    try {
+        fsm::bit_nfa<> _large(_tail + _tail);
+    }
+    catch (const fsm::pattern::pattern_error&) {
+        _thrown = true;
+    }
+    assert(_thrown);
+    const fsm::bit_nfa<2> _large(_tail + _tail);
+    assert(_large.states() == 85);
+    _s[100 - 41] = 'a';
+    _s[100 - 83] = 'a';
+    assert(_large.match(_s)[0].accepted);
+    _s[100 - 83] = 'b';
+    assert(!_large.match(_s)[0].accepted);
+
+    // stepping by hand
+    auto _d = _nfa.entry();
+    for (const char _c : std::string_view("ab")) _d = _nfa.next(_d, _c);
+    assert(_d.any() && !_nfa.acceptable(_d));
+    assert(!_nfa.next(_d, 'c').any());
+    return 0;
+}
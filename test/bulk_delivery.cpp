@@ -0,0 +1,109 @@
+#include "congestion_control.hpp"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace icy;
+
+struct bogus : public fsm::event {};
+
+size_t entries = 0;
+
+/**
+ * @brief 加上计数的处理函数的状态基类
+ */
+struct counted_state : public congestion_state {
+    using congestion_state::handle;
+    virtual size_t handle(const ack&, size_t) { return 0; }
+    virtual size_t handle(const dup_ack&, size_t _n) { // the third one transits
+        const size_t _k = std::min<size_t>(_n, 3 - _dup_acks);
+        _dup_acks += static_cast<std::uint32_t>(_k);
+        return _k;
+    }
+    void entry() override { ++entries; }
+};
+struct counted_slow_start : public basic_slow_start<counted_state> {
+    using basic_slow_start<counted_state>::handle;
+    size_t handle(const ack& _e, size_t _n) override { // the last one reaches ssthresh
+        const size_t _s = _e.segments();
+        const size_t _k = (_s == 0 ? _n : std::min<size_t>(_n, (_ssthresh - _cwnd + _s - 1) / _s));
+        _cwnd += static_cast<std::uint32_t>(_k * _s);
+        _dup_acks = 0;
+        return _k;
+    }
+};
+typedef basic_avoidance<counted_state> counted_avoidance;
+struct counted_recovery : public basic_recovery<counted_state> {
+    using basic_recovery<counted_state>::handle;
+    size_t handle(const dup_ack&, size_t _n) override {
+        _cwnd += static_cast<std::uint32_t>(_n);
+        return _n;
+    }
+};
+
+void start(fsm::context<counted_state>& _fsm) {
+    _fsm.enroll<counted_slow_start, counted_avoidance, counted_recovery>();
+    _fsm.default_entry<counted_slow_start>();
+    _fsm.start();
+}
+bool same(const fsm::context<counted_state>& _a, const fsm::context<counted_state>& _b) {
+    const congestion_state* const _x = _a.state();
+    const congestion_state* const _y = _b.state();
+    return _a.label() == _b.label() && _x->_cwnd == _y->_cwnd && _x->_ssthresh == _y->_ssthresh &&
+    _x->_dup_acks == _y->_dup_acks && _x->_acked == _y->_acked;
+}
+
+int main() {
+    fsm::event_registry<counted_state>::enroll<ack, dup_ack, rto>();
+    fsm::context<counted_state> _single, _bulk, _queued;
+    start(_single);
+    start(_bulk);
+    start(_queued);
+
+    // a transition partway through a burst
+    assert(_bulk.handle_n(ack(), 100) == 100);
+    for (size_t _i = 0; _i != 100; ++_i) _single.handle(ack());
+    assert(_bulk.label() == avoidance::label() && same(_single, _bulk));
+    assert(_bulk.handle_n(dup_ack(), 5) == 5);
+    for (size_t _i = 0; _i != 5; ++_i) _single.handle(dup_ack());
+    assert(_bulk.label() == recovery::label() && same(_single, _bulk));
+    assert(_queued.handle_n(fsm::envelope(ack()), 100) == 100 && _queued.handle_n(fsm::envelope(dup_ack()), 5) == 5);
+    assert(same(_single, _queued));
+
+    // bursts of random length, delivered one by one, in bulk and through the coalescer
+    std::mt19937 _random(7);
+    fsm::coalescer _queue;
+    size_t _entries_single = 0, _entries_bulk = 0;
+    for (size_t _i = 0; _i != 2000; ++_i) {
+        const auto _x = _random() % 100;
+        const size_t _n = 1 + _random() % 40;
+        const fsm::envelope _e = (_x < 60 ? fsm::envelope(ack()) : _x < 98 ? fsm::envelope(dup_ack()) : fsm::envelope(rto()));
+        entries = 0;
+        for (size_t _j = 0; _j != _n; ++_j) assert(_single.handle(_e));
+        _entries_single += entries;
+        entries = 0;
+        assert(_bulk.handle_n(_e, _n) == _n);
+        _entries_bulk += entries;
+        assert(same(_single, _bulk));
+        for (size_t _j = 0; _j != _n; ++_j) _queue.push(_e);
+        if (_i % 10 == 9) {
+            const size_t _events = _queue.events();
+            assert(_queue.size() < _events);
+            assert(_queued.handle_n(fsm::envelope(), 0) == 0);
+            assert(_queue.flush(_queued) == _events && _queue.empty());
+            assert(same(_single, _queued));
+        }
+    }
+    assert(_entries_bulk < _entries_single); // reentries within a burst are elided
+
+    // stop at the first failed event
+    assert(_bulk.handle_n(bogus(), 3) == 0);
+    _queue.push(fsm::envelope(ack()));
+    _queue.push(fsm::envelope(bogus()));
+    _queue.push(fsm::envelope(bogus()));
+    _queue.push(fsm::envelope(ack()));
+    assert(_queue.size() == 3 && _queue[1]._count == 2);
+    assert(_queue.flush(_queued) == 1 && _queue.empty());
+    return 0;
+}
@@ -0,0 +1,117 @@
+#ifndef _ICY_FINITE_STATE_MACHINE_TEST_CONGESTION_CONTROL_HPP_
+#define _ICY_FINITE_STATE_MACHINE_TEST_CONGESTION_CONTROL_HPP_
+
+#include "finite_state_machine.hpp"
+
+#include <cstdint>
+
+#include <algorithm>
+
+struct ack : public icy::fsm::event {
+    ack(std::uint32_t _bytes = 1460) : _bytes(_bytes) {}
+    std::uint32_t segments() const { return (_bytes + 1459) / 1460; }
+    std::uint32_t _bytes;
+};
+struct dup_ack : public icy::fsm::event {};
+struct rto : public icy::fsm::event {};
+
+/**
+ * @brief 测试共用的 tcp 拥塞控制状态机（平坦）
+ * @details slow_start --cwnd >= ssthresh--> avoidance
+ *          slow_start, avoidance --3 dup_ack--> recovery --ack--> avoidance
+ *          * --rto--> slow_start
+ * 数据成员为 tracked，事务模式下被拒绝的事件的写入可以撤销
+ */
+struct congestion_state : public icy::fsm::state {
+    using state = icy::fsm::state;
+    congestion_state& operator=(const congestion_state&) = default;
+    virtual label_type handle(const icy::fsm::event&) override { return state::label(); }
+    virtual label_type handle(const ack&);
+    virtual label_type handle(const dup_ack&);
+    virtual label_type handle(const rto&);
+    label_type transit() override;
+    void assign(const state& _s) override { this->operator=(dynamic_cast<const congestion_state&>(_s)); }
+    void reset() override { _cwnd = 1; _ssthresh = 64; _dup_acks = 0; _acked = 0; }
+    icy::fsm::tracked<std::uint32_t> _cwnd = 1;
+    icy::fsm::tracked<std::uint32_t> _ssthresh = 64;
+    icy::fsm::tracked<std::uint32_t> _dup_acks = 0;
+    icy::fsm::tracked<std::uint32_t> _acked = 0; // segments acknowledged in the current round trip
+};
+
+/**
+ * @details 各状态以状态基类为参数，测试可以在 congestion_state 的派生类中加入处理函数（例如计数的处理函数）
+ * @tparam _Bs 状态基类（congestion_state 或其派生类）
+ */
+template <typename _Bs = congestion_state> struct basic_avoidance : public _Bs {
+    static constexpr icy::fsm::state::label_type label() { return "avoidance"; }
+};
+template <typename _Bs = congestion_state> struct basic_slow_start : public _Bs {
+    using typename _Bs::label_type;
+    static constexpr label_type label() { return "slow_start"; }
+    using _Bs::handle;
+    label_type handle(const ack& _e) override { // one more segment per acknowledged segment
+        this->_cwnd += _e.segments();
+        this->_dup_acks = 0;
+        return {};
+    }
+    label_type transit() override {
+        if (this->_cwnd >= this->_ssthresh) {
+            return basic_avoidance<>::label();
+        }
+        return _Bs::transit();
+    }
+};
+template <typename _Bs = congestion_state> struct basic_recovery : public _Bs {
+    using typename _Bs::label_type;
+    static constexpr label_type label() { return "recovery"; }
+    using _Bs::handle;
+    label_type handle(const ack&) override {
+        this->_cwnd = this->_ssthresh;
+        this->_dup_acks = 0;
+        return basic_avoidance<>::label();
+    }
+    label_type handle(const dup_ack&) override {
+        ++this->_cwnd;
+        return {};
+    }
+};
+typedef basic_slow_start<> slow_start;
+typedef basic_avoidance<> avoidance;
+typedef basic_recovery<> recovery;
+
+inline auto congestion_state::handle(const ack& _e) -> label_type { // one more segment per round trip
+    _acked += _e.segments();
+    if (_acked >= _cwnd) {
+        ++_cwnd;
+        _acked = 0;
+    }
+    _dup_acks = 0;
+    return {};
+}
+inline auto congestion_state::handle(const dup_ack&) -> label_type {
+    ++_dup_acks;
+    return {};
+}
+inline auto congestion_state::handle(const rto&) -> label_type {
+    _ssthresh = std::max<std::uint32_t>(_cwnd / 2, 2);
+    _cwnd = 1;
+    _dup_acks = 0;
+    return slow_start::label();
+}
+inline auto congestion_state::transit() -> label_type {
+    if (_dup_acks >= 3) {
+        _ssthresh = std::max<std::uint32_t>(_cwnd / 2, 2);
+        _cwnd = _ssthresh + 3;
+        _dup_acks = 0;
+        return recovery::label();
+    }
+    return {};
+}
+
+inline void start(icy::fsm::context<congestion_state>& _fsm) {
+    _fsm.enroll<slow_start, avoidance, recovery>();
+    _fsm.default_entry<slow_start>();
+    _fsm.start();
+}
+
+#endif // _ICY_FINITE_STATE_MACHINE_TEST_CONGESTION_CONTROL_HPP_
@@ -0,0 +1,72 @@
+#include "congestion_control.hpp"
+#include "event_trace.hpp"
+
+#include <random>
+#include <sstream>
+#include <vector>
+
+using namespace icy;
+
+int main() {
+    fsm::event_registry<congestion_state>::enroll<ack, dup_ack, rto>();
+    assert(fsm::event_registry<congestion_state>::find(typeid(dup_ack).name()) == fsm::event_index::of<dup_ack>());
+    assert(fsm::event_registry<congestion_state>::find("no such event") == fsm::envelope::npos);
+
+    // record
+    std::stringstream _log;
+    std::vector<std::string_view> _states;
+    {
+        fsm::context<congestion_state> _fsm;
+        start(_fsm);
+        fsm::trace_writer _writer(_log);
+        _fsm.trace(&_writer);
+        std::mt19937 _random(42);
+        for (size_t _i = 0; _i != 10000; ++_i) {
+            const auto _x = _random() % 100;
+            if (_x < 80) _fsm.handle(ack(static_cast<std::uint32_t>(_random() % 3000)));
+            else if (_x < 98) _fsm.handle(dup_ack());
+            else _fsm.handle(fsm::envelope(rto()));
+            _states.push_back(_fsm.label());
+        }
+        _fsm.trace(nullptr);
+        _fsm.handle(rto());
+        assert(_writer.events() == 10000);
+    }
+
+    // load and replay
+    const fsm::trace _trace(_log);
+    assert(_trace.size() == 10000);
+    for (size_t _i = 0; _i != _trace.size(); ++_i) {
+        assert(_trace.state_name(_trace[_i]) == _states[_i]);
+    }
+    std::vector<fsm::context<congestion_state>> _machines(3);
+    std::vector<fsm::context<congestion_state>*> _pointers;
+    for (auto& _f : _machines) {
+        start(_f);
+        _pointers.push_back(&_f);
+    }
+    const auto _r = fsm::replay<congestion_state>(_trace, _pointers);
+    assert(_r.events == 30000 && _r.mismatches == 0);
+    assert(_r.events_per_second > 0);
+    assert(_r.p50 <= _r.p99 && _r.p99 <= _r.p999 && _r.p999 <= _r.max);
+
+    // behaviour change is detected
+    fsm::context<congestion_state> _other;
+    _other.enroll<slow_start, avoidance, recovery>();
+    _other.start<avoidance>();
+    const auto _d = fsm::replay(_trace, _other);
+    assert(_d.mismatches != 0 && _d.first_mismatch != static_cast<size_t>(-1));
+
+    for (const std::string& _bad : {std::string(""), std::string("FSMX\x01"), std::string("FSMT\x02"), std::string("FSMT\x01R\x00\x00", 8)}) {
+        std::stringstream _s(_bad);
+        bool _thrown = false;
+        try {
+            fsm::trace _t(_s);
+        }
+        catch (const fsm::trace_error&) {
+            _thrown = true;
+        }
+        assert(_thrown);
+    }
+    return 0;
+}
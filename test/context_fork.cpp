@@ -0,0 +1,95 @@
+#include "context_fork.hpp"
+
+using namespace icy;
+
+auto number_state::handle(const fsm::character::digit& _e) -> label_type {
+    _value = _value * 10 + (_e.value() - '0');
+    return {};
+}
+auto number_state::assign(const state& _s) -> void {
+    this->operator=(dynamic_cast<const number_state&>(_s));
+}
+
+auto integer::handle(const fsm::character::dot& _e) -> label_type {
+    return fraction::label();
+}
+auto fraction::handle(const fsm::character::digit& _e) -> label_type {
+    _scale *= 10;
+    return number_state::handle(_e);
+}
+
+int main() {
+    fsm::context<number_state> _fsm;
+    _fsm.enroll<integer, fraction>();
+    _fsm.default_entry<integer>();
+    _fsm.start();
+    for (const char _c : std::string_view("12")) {
+        assert(fsm::character::handle(_fsm, _c));
+    }
+    assert(_fsm.state()->_value == 12);
+
+    // state objects are shared until the first write
+    {
+        auto _child = _fsm.fork();
+        assert(_child.state() == _fsm.state());
+        assert(fsm::character::handle(_child, '3'));
+        assert(_child.state() != _fsm.state());
+        assert(_child.state()->_value == 123);
+        assert(_fsm.state()->_value == 12);
+        // the parent keeps running on its own copy
+        assert(fsm::character::handle(_fsm, '4'));
+        assert(_fsm.state()->_value == 124);
+        assert(_child.state()->_value == 123);
+    }
+    assert(_fsm.state()->_value == 124);
+
+    // rollback discards the speculative input
+    {
+        auto _child = _fsm.fork();
+        assert(fsm::character::handle(_child, '.'));
+        assert(fsm::character::handle(_child, '5'));
+        assert(dynamic_cast<const fraction*>(_child.state()) != nullptr);
+        _child.rollback();
+        assert(dynamic_cast<const integer*>(_child.state()) != nullptr);
+        assert(_child.state() == _fsm.state());
+        assert(_child.state()->_value == 124);
+    }
+
+    // commit publishes the speculative input to the parent
+    {
+        auto _child = _fsm.fork();
+        assert(fsm::character::handle(_child, '.'));
+        assert(fsm::character::handle(_child, '5'));
+        assert(!fsm::character::handle(_child, '.'));
+        _child.rollback();
+        assert(fsm::character::handle(_child, '.'));
+        assert(fsm::character::handle(_child, '5'));
+        _child.commit();
+    }
+    assert(dynamic_cast<const fraction*>(_fsm.state()) != nullptr);
+    assert(_fsm.state()->_value == 1245 && _fsm.state()->_scale == 10);
+
+    // a child may change the structure without affecting its parent
+    {
+        auto _child = _fsm.fork();
+        _child.accept<fraction>();
+        assert(_child.acceptable());
+        assert(!_fsm.acceptable());
+    }
+    _fsm.stop();
+    _fsm.start();
+    assert(dynamic_cast<const integer*>(_fsm.state()) != nullptr);
+    assert(_fsm.state()->_value == 0);
+
+    // copy on write copies through the concrete type, without assign
+    fsm::context<tally> _tally;
+    _tally.enroll<tally>();
+    _tally.start<tally>();
+    assert(fsm::character::handle(_tally, "12") == 2);
+    {
+        auto _child = _tally.fork();
+        assert(fsm::character::handle(_child, '3'));
+        assert(_child.state()->_count == 3 && _tally.state()->_count == 2);
+    }
+    return 0;
+}
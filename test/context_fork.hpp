@@ -0,0 +1,43 @@
+#ifndef _ICY_FINITE_STATE_MACHINE_TEST_CONTEXT_FORK_HPP_
+#define _ICY_FINITE_STATE_MACHINE_TEST_CONTEXT_FORK_HPP_
+
+#include "finite_state_machine.hpp"
+
+/**
+ * @details number --dot--> fraction
+ */
+struct number_state : public icy::fsm::state {
+    using state = icy::fsm::state;
+    number_state& operator=(const number_state&) = default;
+    virtual label_type handle(const icy::fsm::event&) override { return state::label(); }
+    virtual label_type handle(const icy::fsm::character::digit&);
+    virtual label_type handle(const icy::fsm::character::dot&) { return state::label(); }
+    label_type transit() override { return {}; }
+    void assign(const state&) override;
+    void reset() override { _value = 0; _scale = 1; }
+    long _value = 0;
+    long _scale = 1;
+};
+
+struct integer : public number_state {
+    FSM_STATE_LABEL
+    label_type handle(const icy::fsm::character::dot&) override;
+};
+struct fraction : public number_state {
+    FSM_STATE_LABEL
+    label_type handle(const icy::fsm::character::digit&) override;
+};
+
+/**
+ * @brief 没有覆盖 assign 的状态
+ */
+struct tally : public icy::fsm::state {
+    FSM_STATE_LABEL
+    using state = icy::fsm::state;
+    virtual label_type handle(const icy::fsm::event&) override { return state::label(); }
+    virtual label_type handle(const icy::fsm::character::digit&) { ++_count; return {}; }
+    label_type transit() override { return {}; }
+    long _count = 0;
+};
+
+#endif // _ICY_FINITE_STATE_MACHINE_TEST_CONTEXT_FORK_HPP_
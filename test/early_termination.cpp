@@ -0,0 +1,72 @@
+#include "pattern.hpp"
+
+#include <string>
+#include <vector>
+
+using namespace icy;
+
+/**
+ * @brief a [0-9]^+ ; "a#" enters a state which loops on anything but never accepts
+ */
+fsm::dfa ticket() {
+    fsm::dfa _d;
+    const auto _a = _d.add_state();
+    const auto _b = _d.add_state();
+    const auto _c = _d.add_state(true);
+    const auto _trap = _d.add_state();
+    _d.link(_a, 'a', _b);
+    for (char _x = '0'; _x <= '9'; ++_x) {
+        _d.link(_b, _x, _c);
+        _d.link(_c, _x, _c);
+    }
+    _d.link(_b, '#', _trap);
+    for (int _x = 0; _x != 256; ++_x) {
+        _d.link(_trap, static_cast<unsigned char>(_x), _trap);
+    }
+    return _d;
+}
+
+int main() {
+    auto _ticket = ticket();
+    assert(!_ticket.doomed(3)); // not analyzed
+    _ticket.analyze();
+    assert(_ticket.doomed(3) && !_ticket.doomed(0) && !_ticket.doomed(2));
+    assert(!_ticket.absorbing(2));
+    _ticket.minimize();
+    const auto _trap = _ticket.next(_ticket.next(_ticket.entry(), 'a'), '#');
+    assert(_ticket.doomed(_trap));
+    // stops right after entering the doomed state
+    const std::string _long_invalid = "a#" + std::string(100000, '7');
+    assert(!_ticket.match(_long_invalid).accepted && _ticket.match(_long_invalid).length == 2);
+    assert(_ticket.match("a12b").accepted && _ticket.match("a12b").length == 3);
+
+    // everything after "//" is a comment: accepting and absorbing
+    const auto _comment = fsm::pattern::compile("[ \\t]*//.*");
+    const auto _body = _comment.next(_comment.next(_comment.entry(), '/'), '/');
+    assert(_comment.absorbing(_body));
+    const std::string _long_comment = "  //" + std::string(100000, 'x');
+    assert(_comment.match(_long_comment).accepted && _comment.match(_long_comment).length == _long_comment.size());
+    assert(!_comment.absorbing(_comment.entry()) && !_comment.doomed(_comment.entry()));
+
+    // the same results from every engine
+    const std::vector<std::string> _inputs = {
+        "", "a", "a#", "a#1", "a1", "a12b", _long_invalid, "//", " \t// x", "/", "/x", _long_comment
+    };
+    const std::vector<fsm::dfa> _machines = {_ticket, _comment};
+    const fsm::dfa_set _product(_machines);
+    const fsm::dfa_set _bank(_machines, 0);
+    assert(_product.is_product());
+    std::vector<std::string_view> _views(_inputs.cbegin(), _inputs.cend());
+    for (size_t _j = 0; _j != _machines.size(); ++_j) {
+        const auto _batch = _machines[_j].match(std::span<const std::string_view>(_views));
+        for (size_t _i = 0; _i != _inputs.size(); ++_i) {
+            const auto _r = _machines[_j].match(_inputs[_i]);
+            const auto _p = _product.match(_inputs[_i])[_j];
+            const auto _b = _bank.match(_inputs[_i])[_j];
+            assert(_batch[_i].accepted == _r.accepted && _batch[_i].length == _r.length);
+            assert(_p.accepted == _r.accepted && _p.length == _r.length);
+            assert(_b.accepted == _r.accepted && _b.length == _r.length);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include "event_envelope.hpp"
+
+#include <vector>
+
+using namespace icy;
+
+auto link_state::handle(const fsm::event& _e) -> label_type {
+    _last = "event";
+    return state::label();
+}
+auto link_state::handle(const fsm::character::alpha& _e) -> label_type {
+    _last = "alpha";
+    return {};
+}
+auto link_state::handle(const fsm::character::digit& _e) -> label_type {
+    _last = "digit";
+    return {};
+}
+auto link_state::handle(const packet& _e) -> label_type {
+    return handle(fsm::event(_e));
+}
+auto link_state::handle(const heartbeat& _e) -> label_type {
+    _last = "heartbeat";
+    return {};
+}
+auto link_state::assign(const state& _s) -> void {
+    this->operator=(dynamic_cast<const link_state&>(_s));
+}
+
+auto idle::handle(const packet& _e) -> label_type {
+    _bytes += _e._len;
+    _last = "packet";
+    return receiving::label();
+}
+auto receiving::handle(const packet& _e) -> label_type {
+    _bytes += _e._len;
+    _last = "packet";
+    return {};
+}
+auto receiving::handle(const heartbeat& _e) -> label_type {
+    _last = "heartbeat";
+    return idle::label();
+}
+
+int main() {
+    using namespace fsm::character;
+    fsm::event_registry<link_state>::enroll<packet, heartbeat, lower_case, upper_case, digit>();
+    assert(fsm::event_registry<link_state>::contains(fsm::event_index::of<packet>()));
+    assert(!fsm::event_registry<link_state>::contains(fsm::event_index::of<unknown>()));
+
+    fsm::context<link_state> _fsm;
+    _fsm.enroll<idle, receiving>();
+    _fsm.default_entry<idle>();
+    _fsm.start();
+
+    // events off a queue, concrete types erased
+    const std::vector<fsm::envelope> _queue = {
+        packet(1, 100), packet(2, 50), lower_case('x'), upper_case('Y'), digit('7'), heartbeat(), heartbeat()
+    };
+    const std::vector<std::string> _expect = {
+        "packet", "packet", "alpha", "alpha", "digit", "heartbeat", "heartbeat"
+    };
+    for (size_t _i = 0; _i != _queue.size(); ++_i) {
+        assert(_fsm.handle(_queue[_i]));
+        assert(_fsm.state()->_last == _expect[_i]);
+    }
+    assert(_fsm.state()->_bytes == 150);
+    assert(_fsm.state() != nullptr && dynamic_cast<const idle*>(_fsm.state()) != nullptr);
+
+    const fsm::envelope _p(packet(3, 20));
+    assert(_p.get<packet>()._seq == 3 && _p.get<packet>()._len == 20);
+    assert(_p == fsm::envelope(packet(3, 20)));
+    assert(!(_p == fsm::envelope(packet(3, 21))));
+    assert(!(_p == fsm::envelope(heartbeat())));
+
+    // unregistered event types are rejected without reaching any handler
+    const std::string _last = _fsm.state()->_last;
+    assert(!_fsm.handle(fsm::envelope(unknown())));
+    assert(!_fsm.handle(fsm::envelope(dot())));
+    assert(!_fsm.handle(fsm::envelope()));
+    assert(_fsm.handle_n(fsm::envelope(unknown()), 3) == 0);
+    assert(_fsm.state()->_last == _last);
+    return 0;
+}
@@ -0,0 +1,44 @@
+#ifndef _ICY_FINITE_STATE_MACHINE_TEST_EVENT_ENVELOPE_HPP_
+#define _ICY_FINITE_STATE_MACHINE_TEST_EVENT_ENVELOPE_HPP_
+
+#include "finite_state_machine.hpp"
+
+#include <string>
+
+struct packet : public icy::fsm::event {
+    packet(unsigned _seq, unsigned _len) : _seq(_seq), _len(_len) {}
+    unsigned _seq;
+    unsigned _len;
+};
+struct heartbeat : public icy::fsm::event {};
+struct unknown : public icy::fsm::event {};
+
+/**
+ * @details idle --packet--> receiving --heartbeat--> idle
+ */
+struct link_state : public icy::fsm::state {
+    using state = icy::fsm::state;
+    link_state& operator=(const link_state&) = default;
+    virtual label_type handle(const icy::fsm::event&) override;
+    virtual label_type handle(const icy::fsm::character::alpha&);
+    virtual label_type handle(const icy::fsm::character::digit&);
+    virtual label_type handle(const packet&);
+    virtual label_type handle(const heartbeat&);
+    label_type transit() override { return {}; }
+    void assign(const state&) override;
+    void reset() override { _bytes = 0; _last.clear(); }
+    size_t _bytes = 0;
+    std::string _last;
+};
+
+struct idle : public link_state {
+    FSM_STATE_LABEL
+    label_type handle(const packet&) override;
+};
+struct receiving : public link_state {
+    FSM_STATE_LABEL
+    label_type handle(const packet&) override;
+    label_type handle(const heartbeat&) override;
+};
+
+#endif // _ICY_FINITE_STATE_MACHINE_TEST_EVENT_ENVELOPE_HPP_
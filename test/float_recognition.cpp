@@ -1,4 +1,8 @@
 #include "float_recognition.hpp"
+#include "finite_automaton.hpp"
+#include "decimal.hpp"
+
+#include <cstdlib>
 
 using namespace icy;
 
@@ -113,23 +117,29 @@ int main() {
     _fsm.accept<BCFJ, DEFJ, HIJ>();
     _fsm.default_entry<AB>();
 
+    // the value is accumulated from the bytes the machine accepts
+    auto value_of = [](const std::string& _expect, const fsm::decimal& _d, const std::string& _s) -> bool {
+        return _d.length() == _expect.size() && _d.value(_s) == std::strtod(_expect.c_str(), nullptr);
+    };
     auto parse_float = [&](const std::string& _s, const std::string& _expect) -> bool {
         _fsm.restart();
+        fsm::decimal _d;
         for (const auto& _c : _s) {
             bool _result = fsm::character::handle(_fsm, _c);
             if (!_result) {
                 size_t _len = _fsm.state()->length();
                 if (_fsm.acceptable()) {
-                    return _expect == _s.substr(0, _len);
+                    return _expect == _s.substr(0, _len) && value_of(_expect, _d, _s);
                 }
                 else {
                     return _expect.empty();
                 }
             }
+            _d.push(_c);
         }
         if (_fsm.acceptable()) {
             size_t _len = _fsm.state()->length();
-            return _expect == _s.substr(0, _len);
+            return _expect == _s.substr(0, _len) && value_of(_expect, _d, _s);
         }
         return _expect.empty();
     };
@@ -144,5 +154,40 @@ int main() {
     assert(parse_float("-2.3e-3", "-2.3e-3"));
     assert(parse_float("-2e+33e-3", "-2e+33"));
 
+    _fsm.reset_with(fsm::reset_policy::entry);
+    assert(parse_float("1", "1"));
+    assert(parse_float("-0.123e2.13", "-0.123e2"));
+    assert(parse_float("+10e.123e2.13", ""));
+    assert(parse_float("-2.3e-3", "-2.3e-3"));
+    assert(parse_float("-2e+33e-3", "-2e+33"));
+
+    auto _dfa = fsm::dfa::compile(_fsm);
+    const auto _report = _dfa.minimize();
+    assert(_report.states_before == 8 && _report.states_after == 8);
+    assert(_report.classes_after == 5); // [0-9] [+-] . e others
+    auto parse_float_compiled = [&](const std::string& _s, const std::string& _expect) -> bool {
+        const auto _r = _dfa.match(_s);
+        if (_r.accepted) return _expect == _s.substr(0, _r.length);
+        return _expect.empty();
+    };
+    assert(parse_float_compiled("1", "1"));
+    assert(parse_float_compiled("-0.23", "-0.23"));
+    assert(parse_float_compiled("1e9", "1e9"));
+    assert(parse_float_compiled("-0.123e2.13", "-0.123e2"));
+    assert(parse_float_compiled("+0.1.123e2.13", "+0.1"));
+    assert(parse_float_compiled("+10.1e.123e2.13", ""));
+    assert(parse_float_compiled("+10e.123e2.13", ""));
+    assert(parse_float_compiled("-2.3e-3", "-2.3e-3"));
+    assert(parse_float_compiled("-2e+33e-3", "-2e+33"));
+
+    // values through the compiled machine
+    for (const std::string_view _s : {"1", "-0.23", "1e9", "-0.123e2.13", "+0.1.123e2.13", "-2.3e-3", "-2e+33e-3", "1e400"}) {
+        const auto _r = fsm::parse_float(_dfa, _s);
+        const auto _m = _dfa.match(_s);
+        assert(_r.accepted == _m.accepted && _r.length == _m.length);
+        assert(_r.value == std::strtod(std::string(_s.substr(0, _r.length)).c_str(), nullptr));
+    }
+    assert(!fsm::parse_float(_dfa, "+10e.123e2.13").accepted);
+
     return 0;
 }
\ No newline at end of file
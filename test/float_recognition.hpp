@@ -30,6 +30,7 @@ struct float_recognition_state : public icy::fsm::state {
 
 struct AB : public float_recognition_state {
     FSM_STATE_LABEL
+    typedef icy::fsm::increment<&float_recognition_state::_length> pure_action;
     using state = icy::fsm::state;
     label_type handle(const icy::fsm::character::digit& _e) override;
     label_type handle(const icy::fsm::character::plus& _e) override;
@@ -40,6 +41,7 @@ struct AB : public float_recognition_state {
 };
 struct B : public float_recognition_state {
     FSM_STATE_LABEL
+    typedef icy::fsm::increment<&float_recognition_state::_length> pure_action;
     label_type handle(const icy::fsm::character::digit& _e) override;
 };
 struct BCFJ : public float_recognition_state {
@@ -51,6 +53,7 @@ struct BCFJ : public float_recognition_state {
 };
 struct D : public float_recognition_state {
     FSM_STATE_LABEL
+    typedef icy::fsm::increment<&float_recognition_state::_length> pure_action;
     using state = icy::fsm::state;
     label_type handle(const icy::fsm::character::digit& _e) override;
 };
@@ -62,6 +65,7 @@ struct DEFJ : public float_recognition_state {
 };
 struct GH : public float_recognition_state {
     FSM_STATE_LABEL
+    typedef icy::fsm::increment<&float_recognition_state::_length> pure_action;
     using state = icy::fsm::state;
     label_type handle(const icy::fsm::character::digit& _e) override;
     label_type handle(const icy::fsm::character::plus& _e) override;
@@ -69,11 +73,13 @@ struct GH : public float_recognition_state {
 };
 struct H : public float_recognition_state {
     FSM_STATE_LABEL
+    typedef icy::fsm::increment<&float_recognition_state::_length> pure_action;
     using state = icy::fsm::state;
     label_type handle(const icy::fsm::character::digit& _e) override;
 };
 struct HIJ : public float_recognition_state {
     FSM_STATE_LABEL
+    typedef icy::fsm::increment<&float_recognition_state::_length> pure_action;
     using state = icy::fsm::state;
     label_type handle(const icy::fsm::character::digit& _e) override;
 };
@@ -0,0 +1,35 @@
+#include "float_value.hpp"
+
+#include <cmath>
+#include <limits>
+
+using namespace icy;
+
+int main() {
+    auto _r = fsm::parse_float("-0.114e5.14");
+    assert(_r.accepted && _r.length == 8 && _r.value == -11400.0);
+    _r = fsm::parse_float("+10e.123");
+    assert(!_r.accepted && _r.length == 4);
+    assert(fsm::parse_float("-0").value == 0.0 && std::signbit(fsm::parse_float("-0").value));
+    assert(fsm::parse_float("1e400").value == std::numeric_limits<double>::infinity());
+    assert(fsm::parse_float("-1e-400").value == 0.0 && std::signbit(fsm::parse_float("-1e-400").value));
+
+    fsm::decimal _d;
+    for (const char _c : std::string_view("-0.00125e+3")) _d.push(_c);
+    assert(_d.negative() && _d.mantissa() == 125 && _d.exponent() == -2 && !_d.truncated());
+    assert(_d.value("-0.00125e+3") == -1.25);
+
+    // correctly rounded, bit for bit equal to strtod
+    for (const char* _s : {"0", "1", "9007199254740992", "9007199254740993", "9007199254740993.0000000001",
+        "1e23", "8.98846567431158e307", "1.7976931348623157e308", "1.7976931348623159e308", "4.9e-324", "2.4e-324",
+        "2.2250738585072011e-308", "2.2250738585072014e-308", "0.1", "0.3", "123456789012345678901234567890e-10",
+        "1e22", "1e-22", "123456e30", "0.000000000000000000000000000001", "3.14159265358979323846264338327950288",
+        "1448997445238699", "2.0e-3", "7e-10", "1.00000000000000011102230246251565404236316680908203125"}) {
+        assert(same(fsm::parse_float(_s), recognize_then_strtod(_s)));
+    }
+    const std::vector<std::string> _inputs = random_floats(20000);
+    for (const std::string& _s : _inputs) {
+        assert(same(fsm::parse_float(_s), recognize_then_strtod(_s)));
+    }
+    return 0;
+}
@@ -0,0 +1,54 @@
+#ifndef _ICY_FINITE_STATE_MACHINE_TEST_FLOAT_VALUE_HPP_
+#define _ICY_FINITE_STATE_MACHINE_TEST_FLOAT_VALUE_HPP_
+
+#include "decimal.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * @brief recognize, then convert with strtod
+ */
+inline icy::fsm::float_result recognize_then_strtod(std::string_view _s) {
+    const auto _m = icy::fsm::static_machine<icy::fsm::float_syntax>.match(_s);
+    icy::fsm::float_result _r{_m.accepted, _m.length, 0};
+    if (_m.accepted) _r.value = std::strtod(std::string(_s.substr(0, _m.length)).c_str(), nullptr);
+    return _r;
+}
+inline bool same(const icy::fsm::float_result& _a, const icy::fsm::float_result& _b) {
+    return _a.accepted == _b.accepted && _a.length == _b.length && std::memcmp(&_a.value, &_b.value, sizeof(double)) == 0;
+}
+
+/**
+ * @brief random floats, each followed by ','
+ * @details 每 10 个中各有一个长整数部分、长小数部分与大指数
+ */
+inline std::vector<std::string> random_floats(size_t _n, std::mt19937_64::result_type _seed = 42) {
+    std::mt19937_64 _random(_seed);
+    auto _digits = [&](size_t _k) {
+        std::string _s;
+        for (size_t _i = 0; _i != _k; ++_i) _s.push_back(static_cast<char>('0' + _random() % 10));
+        return _s;
+    };
+    std::vector<std::string> _inputs;
+    _inputs.reserve(_n);
+    for (size_t _i = 0; _i != _n; ++_i) {
+        std::string _s;
+        if (_random() % 2) _s.push_back(_random() % 2 ? '-' : '+');
+        _s += _digits(1 + _random() % (_i % 10 == 0 ? 30 : 8));
+        if (_random() % 2) _s += "." + _digits(1 + _random() % (_i % 10 == 1 ? 30 : 8));
+        if (_random() % 3 == 0) {
+            _s += "e";
+            if (_random() % 2) _s.push_back(_random() % 2 ? '-' : '+');
+            _s += std::to_string(_random() % (_i % 10 == 2 ? 400 : 30));
+        }
+        _s += ",";
+        _inputs.push_back(std::move(_s));
+    }
+    return _inputs;
+}
+
+#endif // _ICY_FINITE_STATE_MACHINE_TEST_FLOAT_VALUE_HPP_
@@ -0,0 +1,32 @@
+#include "float_value.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+using namespace icy;
+
+/**
+ * @brief parse_float against recognize-then-strtod, not run by ctest
+ */
+int main(int _argc, char* _argv[]) {
+    const size_t _n = _argc > 1 ? std::strtoul(_argv[1], nullptr, 10) : 200000;
+    const std::vector<std::string> _inputs = random_floats(_n);
+    for (const std::string& _s : _inputs) {
+        if (!same(fsm::parse_float(_s), recognize_then_strtod(_s))) {
+            printf("mismatch: %s\n", _s.c_str());
+            return 1;
+        }
+    }
+
+    typedef std::chrono::steady_clock clock;
+    size_t _finite = 0;
+    clock::time_point _t = clock::now();
+    for (const std::string& _s : _inputs) _finite += std::isfinite(fsm::parse_float(_s).value);
+    const double _fused = std::chrono::duration<double, std::nano>(clock::now() - _t).count() / _inputs.size();
+    _t = clock::now();
+    for (const std::string& _s : _inputs) _finite -= std::isfinite(recognize_then_strtod(_s).value);
+    const double _separate = std::chrono::duration<double, std::nano>(clock::now() - _t).count() / _inputs.size();
+    printf("%zu inputs, parse_float: %.1f ns, recognize then strtod: %.1f ns%s\n", _inputs.size(), _fused, _separate, _finite == 0 ? "" : " (mismatch)");
+    return _finite == 0 ? 0 : 1;
+}
@@ -0,0 +1,31 @@
+#include "float_machine.hpp" // generated by fsm_generate
+#include "code_generator.hpp"
+#include "pattern.hpp"
+
+#include <sstream>
+#include <string>
+
+using namespace icy;
+
+static_assert(float_machine::match("-2.3e-3").accepted);
+static_assert(float_machine::match("-2e+33e-3").length == 6);
+static_assert(!float_machine::match("+10e.123e2.13").accepted);
+
+int main() {
+    const auto _float = fsm::pattern::compile("[+-]?[0-9]+(\\.[0-9]+)?(e[+-]?[0-9]+)?");
+    assert(float_machine::states == _float.size());
+    for (const std::string_view _s : {"", "1", "-0.23", "1e9", "-0.123e2.13", "+0.1.123e2.13", "+10.1e.123e2.13", "e", "\xff"}) {
+        const auto _x = _float.match(_s);
+        const auto _y = float_machine::match(_s);
+        assert(_x.accepted == _y.accepted && _x.length == _y.length);
+    }
+
+    std::ostringstream _os;
+    fsm::generate(_os, fsm::pattern::compile("a|b"), "a_or_b");
+    const std::string _code = _os.str();
+    assert(_code.find("namespace a_or_b {") != std::string::npos);
+    assert(_code.find("#ifndef _FSM_GENERATED_A_OR_B_HPP_") != std::string::npos);
+    assert(_code.find("finite_state_machine.hpp") == std::string::npos);
+    assert(_code.find("case 1: return 1;") != std::string::npos); // a and b share one byte class
+    return 0;
+}
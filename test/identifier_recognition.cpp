@@ -0,0 +1,114 @@
+#include "identifier_recognition.hpp"
+
+using namespace icy;
+
+auto S::handle(const fsm::character::lower_case& _e) -> label_type {
+    return L::label();
+}
+auto L::handle(const fsm::character::lower_case& _e) -> label_type {
+    return L2::label();
+}
+auto L::handle(const fsm::character::digit& _e) -> label_type {
+    return N::label();
+}
+auto L2::handle(const fsm::character::lower_case& _e) -> label_type {
+    return L::label();
+}
+auto L2::handle(const fsm::character::digit& _e) -> label_type {
+    return N::label();
+}
+auto N::handle(const fsm::character::lower_case& _e) -> label_type {
+    return L2::label();
+}
+auto N::handle(const fsm::character::digit& _e) -> label_type {
+    return N::label();
+}
+auto U::handle(const fsm::character::lower_case& _e) -> label_type {
+    return S::label();
+}
+
+int main() {
+    fsm::context<identifier_state> _fsm;
+    _fsm.enroll<S, L, L2, N, U>();
+    _fsm.accept<L, L2, N>();
+    _fsm.default_entry<S>();
+
+    auto _dfa = fsm::dfa::compile(_fsm);
+    assert(_dfa.size() == 4);
+    assert(_dfa.classes() == 256);
+    const auto _raw = _dfa;
+
+    const auto _r = _dfa.minimize();
+    assert(_r.states_before == 4 && _r.states_after == 2);
+    assert(_r.classes_before == 256 && _r.classes_after == 3);
+    assert(_r.table_bytes_after < _r.table_bytes_before);
+    assert(_dfa.classify('a') == _dfa.classify('z'));
+    assert(_dfa.classify('0') == _dfa.classify('9'));
+    assert(_dfa.classify('A') == _dfa.classify('\n'));
+
+    for (const std::string_view _s : {"", "a", "abc", "a1b2", "1ab", "ab-c", "Ab", "ab\xe4", "z9z9z9 "}) {
+        const auto _x = _raw.match(_s);
+        const auto _y = _dfa.match(_s);
+        assert(_x.accepted == _y.accepted && _x.length == _y.length);
+        _fsm.restart();
+        size_t _len = 0;
+        for (const auto& _c : _s) {
+            if (!fsm::character::handle(_fsm, _c)) break;
+            ++_len;
+        }
+        assert(_fsm.acceptable() == _y.accepted && _len == _y.length);
+    }
+    assert(_dfa.match("a1b2").accepted);
+    assert(_dfa.match("ab-c").length == 2);
+    assert(!_dfa.match("1ab").accepted);
+
+    // by default restart resets all states
+    auto& _resets = identifier_state::_resets;
+    _fsm.restart();
+    _resets = 0;
+    _fsm.restart();
+    assert(_resets == 5);
+    // touched: restart only resets states touched since start
+    _fsm.reset_with(fsm::reset_policy::touched);
+    _fsm.restart();
+    _resets = 0;
+    _fsm.stop();
+    assert(_resets == 1);
+    _fsm.start();
+    for (const char _c : std::string_view("ab1")) {
+        fsm::character::handle(_fsm, _c);
+    }
+    _resets = 0;
+    _fsm.restart();
+    assert(_resets == 4); // S L L2 N
+    _fsm.reset_with(fsm::reset_policy::all);
+    _resets = 0;
+    _fsm.restart();
+    assert(_resets == 5);
+    _fsm.reset_with(fsm::reset_policy::entry);
+    _resets = 0;
+    _fsm.restart();
+    assert(_resets == 1); // the entry state only
+    fsm::character::handle(_fsm, 'a');
+    _resets = 0;
+    _fsm.stop();
+    assert(_resets == 0);
+    const auto _again = fsm::dfa::compile(_fsm);
+    assert(_again.size() == _raw.size());
+
+    // non-accepting state with no transitions differs from rejection
+    fsm::dfa _d;
+    const auto _a = _d.add_state();
+    const auto _b = _d.add_state(true);
+    const auto _c = _d.add_state();
+    const auto _e = _d.add_state();
+    _d.link(_a, 'x', _b);
+    _d.link(_b, 'x', _c);
+    _d.link(_b, 'y', _e);
+    _d.minimize();
+    assert(_d.size() == 3);
+    assert(_d.match("xx").length == 2 && _d.match("xy").length == 2);
+    assert(_d.match("xz").length == 1 && _d.match("xz").accepted);
+
+    return 0;
+}
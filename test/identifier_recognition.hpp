@@ -0,0 +1,45 @@
+#ifndef _ICY_FINITE_STATE_MACHINE_TEST_IDENTIFIER_RECOGNITION_HPP_
+#define _ICY_FINITE_STATE_MACHINE_TEST_IDENTIFIER_RECOGNITION_HPP_
+
+#include "finite_state_machine.hpp"
+#include "finite_automaton.hpp"
+
+/**
+ * @details [a-z] [a-z0-9]^*
+ * @note generated-like machine, @c L @c L2 @c N are equivalent states
+ */
+struct identifier_state : public icy::fsm::state {
+    using state = icy::fsm::state;
+    virtual label_type handle(const icy::fsm::event&) override { return state::label(); }
+    virtual label_type handle(const icy::fsm::character::lower_case&) { return state::label(); }
+    virtual label_type handle(const icy::fsm::character::digit&) { return state::label(); }
+    label_type transit() override { return {}; }
+    void reset() override { ++_resets; }
+    inline static size_t _resets = 0;
+};
+
+struct S : public identifier_state {
+    FSM_STATE_LABEL
+    label_type handle(const icy::fsm::character::lower_case& _e) override;
+};
+struct L : public identifier_state {
+    FSM_STATE_LABEL
+    label_type handle(const icy::fsm::character::lower_case& _e) override;
+    label_type handle(const icy::fsm::character::digit& _e) override;
+};
+struct L2 : public identifier_state {
+    FSM_STATE_LABEL
+    label_type handle(const icy::fsm::character::lower_case& _e) override;
+    label_type handle(const icy::fsm::character::digit& _e) override;
+};
+struct N : public identifier_state {
+    FSM_STATE_LABEL
+    label_type handle(const icy::fsm::character::lower_case& _e) override;
+    label_type handle(const icy::fsm::character::digit& _e) override;
+};
+struct U : public identifier_state { // unreachable
+    FSM_STATE_LABEL
+    label_type handle(const icy::fsm::character::lower_case& _e) override;
+};
+
+#endif // _ICY_FINITE_STATE_MACHINE_TEST_IDENTIFIER_RECOGNITION_HPP_
@@ -0,0 +1,134 @@
+#include "finite_state_machine.hpp"
+
+#include <string>
+
+using namespace icy;
+
+/**
+ * @details start --[a-z]--> word --[a-z0-9]--> word
+ *          start --[0-9]--> number --[0-9]--> number
+ */
+struct token_state : public fsm::state {
+    using state = fsm::state;
+    token_state& operator=(const token_state&) = default;
+    virtual label_type handle(const fsm::event&) override { ++_calls; return state::label(); }
+    virtual label_type handle(const fsm::character::lower_case& _e) { return handle(fsm::event(_e)); }
+    virtual label_type handle(const fsm::character::digit& _e) { return handle(fsm::event(_e)); }
+    label_type transit() override { ++_calls; return {}; }
+    void assign(const state& _s) override { this->operator=(dynamic_cast<const token_state&>(_s)); }
+    void reset() override { _length = 0; }
+    void entry() override { ++_entries; }
+    size_t _length = 0;
+    inline static size_t _calls = 0; // handle and transit
+    inline static size_t _entries = 0;
+};
+
+struct word : public token_state {
+    FSM_STATE_LABEL
+    typedef fsm::increment<&token_state::_length> pure_action;
+    label_type handle(const fsm::character::lower_case& _e) override { ++_calls; ++_length; return word::label(); }
+    label_type handle(const fsm::character::digit& _e) override { ++_calls; ++_length; return word::label(); }
+};
+struct number : public token_state {
+    FSM_STATE_LABEL
+    typedef fsm::increment<&token_state::_length> pure_action;
+    label_type handle(const fsm::character::digit& _e) override { ++_calls; ++_length; return number::label(); }
+};
+struct start : public token_state {
+    FSM_STATE_LABEL
+    typedef fsm::increment<&token_state::_length> pure_action;
+    label_type handle(const fsm::character::lower_case& _e) override { ++_calls; ++_length; return word::label(); }
+    label_type handle(const fsm::character::digit& _e) override { ++_calls; ++_length; return number::label(); }
+};
+
+/**
+ * @details group（纯） --[a-z]--> 由子状态的 transit 决定
+ *          ├── brief --_length >= 3--> lengthy
+ *          └── lengthy
+ */
+struct group : public token_state {
+    FSM_STATE_LABEL
+    typedef fsm::events<fsm::character::lower_case> handled_events;
+    typedef fsm::increment<&token_state::_length> pure_action;
+    label_type handle(const fsm::character::lower_case& _e) override { ++_calls; ++_length; return {}; }
+};
+struct lengthy : public token_state {
+    FSM_STATE_LABEL
+    typedef group parent_type;
+    typedef fsm::events<> handled_events;
+};
+struct brief : public token_state { // not pure: transit reads _length
+    FSM_STATE_LABEL
+    typedef group parent_type;
+    typedef fsm::events<> handled_events;
+    label_type transit() override { ++_calls; return _length >= 3 ? lengthy::label() : label_type(); }
+};
+
+/**
+ * @details counting --[a-z], _length >= 3--> full
+ */
+struct full : public token_state {
+    FSM_STATE_LABEL
+};
+struct counting : public token_state { // pure, but leaves the transition to transit
+    FSM_STATE_LABEL
+    typedef fsm::increment<&token_state::_length> pure_action;
+    label_type handle(const fsm::character::lower_case& _e) override { ++_calls; ++_length; return {}; }
+    label_type transit() override { ++_calls; return _length >= 3 ? full::label() : label_type(); }
+};
+
+size_t scan(fsm::context<token_state>& _fsm, const std::string& _s) {
+    _fsm.restart();
+    for (const char _c : _s) {
+        if (!fsm::character::handle(_fsm, _c)) break;
+    }
+    return _fsm.state()->_length;
+}
+
+int main() {
+    fsm::context<token_state> _fsm;
+    _fsm.enroll<start, word, number>();
+    _fsm.default_entry<start>();
+
+    assert(scan(_fsm, "abc12") == 5);
+    assert(scan(_fsm, "123") == 3);
+    const size_t _calls = token_state::_calls;
+    const size_t _entries = token_state::_entries;
+    assert(scan(_fsm, "abc12") == 5 && _fsm.label() == word::label());
+    assert(scan(_fsm, "98765") == 5 && _fsm.label() == number::label());
+    assert(token_state::_calls == _calls); // answered from the cache
+    assert(token_state::_entries - _entries == 12); // entry is still called
+    assert(scan(_fsm, "12a") == 2 && _fsm.label() == number::label());
+    assert(scan(_fsm, "12a") == 2);
+    assert(token_state::_calls == _calls + 2); // failures are not cached
+
+    // enrolling again drops the cache
+    _fsm.enroll<start>();
+    assert(scan(_fsm, "abc12") == 5);
+    assert(token_state::_calls > _calls + 2);
+
+    // a forked machine shares the cache
+    _fsm.restart();
+    fsm::character::handle(_fsm, 'x');
+    const size_t _before = token_state::_calls;
+    auto _fork = _fsm.fork();
+    assert(fsm::character::handle(_fork, '7') && _fork.state()->_length == 2);
+    assert(token_state::_calls == _before && _fsm.state()->_length == 1);
+
+    // transitions decided by transit or by an ancestor are not cached
+    fsm::context<token_state> _nested;
+    _nested.enroll<group, brief, lengthy>();
+    _nested.default_entry<brief>();
+    for (size_t _i = 0; _i != 2; ++_i) {
+        assert(scan(_nested, "ab") == 2 && _nested.label() == brief::label());
+        assert(scan(_nested, "abcd") == 4 && _nested.label() == lengthy::label());
+    }
+    fsm::context<token_state> _flat;
+    _flat.enroll<counting, full>();
+    _flat.default_entry<counting>();
+    for (size_t _i = 0; _i != 2; ++_i) {
+        assert(scan(_flat, "ab") == 2 && _flat.label() == counting::label());
+        assert(scan(_flat, "abc") == 3 && _flat.label() == full::label());
+    }
+    return 0;
+}
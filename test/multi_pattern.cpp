@@ -0,0 +1,79 @@
+#include "finite_automaton.hpp"
+
+#include <string>
+#include <vector>
+
+using namespace icy;
+
+/**
+ * @brief [0-9]^+
+ */
+fsm::dfa number() {
+    fsm::dfa _d;
+    const auto _a = _d.add_state();
+    const auto _b = _d.add_state(true);
+    for (char _c = '0'; _c <= '9'; ++_c) {
+        _d.link(_a, _c, _b);
+        _d.link(_b, _c, _b);
+    }
+    _d.minimize();
+    return _d;
+}
+/**
+ * @brief [a-z_] [a-z0-9_]^*
+ */
+fsm::dfa identifier() {
+    fsm::dfa _d;
+    const auto _a = _d.add_state();
+    const auto _b = _d.add_state(true);
+    for (int _c = 0; _c != 256; ++_c) {
+        if (islower(_c) || _c == '_') {
+            _d.link(_a, _c, _b);
+        }
+        if (islower(_c) || isdigit(_c) || _c == '_') {
+            _d.link(_b, _c, _b);
+        }
+    }
+    _d.minimize();
+    return _d;
+}
+/**
+ * @brief - | -- | -> | -=
+ */
+fsm::dfa minus_operator() {
+    fsm::dfa _d;
+    const auto _a = _d.add_state();
+    const auto _b = _d.add_state(true);
+    const auto _c = _d.add_state(true);
+    _d.link(_a, '-', _b);
+    _d.link(_b, '-', _c);
+    _d.link(_b, '>', _c);
+    _d.link(_b, '=', _c);
+    _d.minimize();
+    return _d;
+}
+
+int main() {
+    const std::vector<fsm::dfa> _machines = {number(), identifier(), minus_operator(), fsm::dfa()};
+    const fsm::dfa_set _product(_machines);
+    const fsm::dfa_set _bank(_machines, 0);
+    assert(_product.is_product() && !_bank.is_product());
+    assert(_product.size() == 4 && _bank.size() == 4);
+    assert(_product.product_states() <= 2 * 2 * 3 + 1);
+    assert(_product.classes() == 5); // [0-9] [a-z_] - [>=] others
+    const std::vector<std::string> _inputs = {
+        "", "0", "123abc", "abc123", "_x1 = 2", "-", "--x", "->y", "-=", "-5", "a-b", "\xff\xfe", "9-"
+    };
+    for (const auto& _s : _inputs) {
+        const auto _p = _product.match(_s);
+        const auto _b = _bank.match(_s);
+        for (size_t _j = 0; _j != _machines.size(); ++_j) {
+            const auto _r = _machines[_j].match(_s);
+            assert(_p[_j].accepted == _r.accepted && _p[_j].length == _r.length);
+            assert(_b[_j].accepted == _r.accepted && _b[_j].length == _r.length);
+        }
+    }
+    const auto _r = _product.match("abc123+");
+    assert(!_r[0].accepted && _r[1].accepted && _r[1].length == 6 && !_r[2].accepted);
+    return 0;
+}
@@ -0,0 +1,41 @@
+#include "nested_congestion_control.hpp"
+
+using namespace icy;
+
+int main() {
+    fsm::context<congestion_state> _fsm;
+    _fsm.enroll<traced<nested_slow_start>, traced<nested_avoidance>, traced<nested_recovery>, traced<probing>, traced<connected>>();
+    _fsm.default_entry<nested_slow_start>();
+    auto _take = []() { std::string _t; _t.swap(trace); return _t; };
+
+    _fsm.start();
+    assert(_take() == "+connected +probing +slow_start ");
+    assert(_fsm.handle(dup_ack())); // handled by probing
+    assert(_take() == "-slow_start +slow_start ");
+    assert(_fsm.label() == slow_start::label());
+    assert(_fsm.state()->_dup_acks == 1);
+    assert(_fsm.handle(dup_ack()));
+    assert(_fsm.handle(dup_ack()));
+    assert(_fsm.label() == recovery::label());
+    assert(_take() == "-slow_start +slow_start -slow_start -probing +recovery ");
+    assert(_fsm.state()->_cwnd == 5 && _fsm.state()->_ssthresh == 2);
+    assert(_fsm.handle(dup_ack())); // handled by recovery itself
+    assert(_fsm.state()->_dup_acks == 0 && _fsm.state()->_cwnd == 6);
+    _take();
+    assert(_fsm.handle(rto())); // handled by connected
+    assert(_take() == "-recovery +probing +slow_start ");
+    assert(_fsm.state()->_cwnd == 1 && _fsm.state()->_ssthresh == 3);
+    size_t _acks = 0;
+    while (_fsm.label() == slow_start::label()) {
+        assert(_fsm.handle(ack()));
+        ++_acks;
+    }
+    assert(_acks == 2);
+    assert(_fsm.label() == avoidance::label());
+    assert(_take().ends_with("-slow_start +avoidance "));
+    assert(!_fsm.handle(message())); // no state handles it
+    assert(_fsm.label() == avoidance::label());
+    _fsm.stop();
+    assert(_take() == "-avoidance -probing -connected ");
+    return 0;
+}
@@ -0,0 +1,49 @@
+#ifndef _ICY_FINITE_STATE_MACHINE_TEST_NESTED_CONGESTION_CONTROL_HPP_
+#define _ICY_FINITE_STATE_MACHINE_TEST_NESTED_CONGESTION_CONTROL_HPP_
+
+#include "congestion_control.hpp"
+
+#include <string>
+
+struct message : public icy::fsm::event {};
+
+/**
+ * @brief 在共用的拥塞控制状态机上加入父状态
+ * @details connected
+ *          ├── probing
+ *          │   ├── slow_start
+ *          │   └── avoidance
+ *          └── recovery
+ */
+struct connected : public congestion_state {
+    FSM_STATE_LABEL
+    typedef icy::fsm::events<rto> handled_events;
+};
+struct probing : public congestion_state {
+    FSM_STATE_LABEL
+    typedef connected parent_type;
+    typedef icy::fsm::events<dup_ack> handled_events;
+};
+struct nested_slow_start : public slow_start {
+    typedef probing parent_type;
+    typedef icy::fsm::events<ack> handled_events;
+};
+struct nested_avoidance : public avoidance {
+    typedef probing parent_type;
+    typedef icy::fsm::events<ack> handled_events;
+};
+struct nested_recovery : public recovery {
+    typedef connected parent_type;
+    typedef icy::fsm::events<ack, dup_ack> handled_events;
+};
+
+inline std::string trace;
+/**
+ * @brief 记录进入与退出
+ */
+template <typename _St> struct traced : public _St {
+    void entry() override { trace.append("+").append(_St::label()).append(" "); }
+    void exit() override { trace.append("-").append(_St::label()).append(" "); }
+};
+
+#endif // _ICY_FINITE_STATE_MACHINE_TEST_NESTED_CONGESTION_CONTROL_HPP_
@@ -0,0 +1,63 @@
+#include "symbol_token.hpp"
+
+#include <string>
+
+using namespace icy;
+using namespace icy::fsm::character;
+
+constexpr symbol_trie<> _symbols(
+    "plus +\n"
+    "minus -\n"
+    "right_angle >\n"
+    "left_angle <\n"
+    "assignment =\n"
+    "\n"
+    "increment ++\n"
+    "decrement --\n"
+    "arrow ->\n"
+    "shift_assignment <<=\n");
+static_assert(_symbols.size() == 9 && _symbols.lookahead() == 3);
+static_assert(_symbols.name(_symbols.match("->x").index) == "arrow" && _symbols.match("->x").length == 2);
+static_assert(_symbols.name(_symbols.match("---").index) == "decrement");
+static_assert(_symbols.name(_symbols.match("-x").index) == "minus");
+static_assert(_symbols.name(_symbols.match("<<=").index) == "shift_assignment");
+static_assert(_symbols.name(_symbols.match("<<x").index) == "left_angle" && _symbols.match("<<x").length == 1);
+static_assert(_symbols.match("x").index == symbol_trie<>::npos && _symbols.match("").length == 0);
+
+constexpr size_t count_tokens(std::string_view _s) {
+    size_t _n = 0;
+    munch(_symbols, _s, [&](size_t, std::string_view) { return ++_n; }, [&](char) { return ++_n; });
+    return _n;
+}
+static_assert(count_tokens("a--->b<<=c") == 6); // a -- -> b <<= c
+
+/**
+ * @brief 记录收到的事件
+ */
+struct recorder : public fsm::state {
+    FSM_STATE_LABEL
+    using state = fsm::state;
+    label_type handle(const fsm::event&) override { return state::label(); }
+    virtual label_type handle(const ascii_code& _e) { _tokens.push_back(_e.value()); _tokens.push_back(' '); return {}; }
+    virtual label_type handle(const operator_code& _e) { _tokens.append("op:").append(_e.value()).push_back(' '); return {}; }
+    virtual label_type handle(const semicolon& _e) { return state::label(); }
+    label_type transit() override { return {}; }
+    std::string _tokens;
+};
+
+int main() {
+    fsm::context<recorder> _fsm;
+    _fsm.enroll<recorder>();
+    _fsm.start<recorder>();
+    const std::string _s = "i++-->-j;k";
+    assert(handle_operators(_fsm, _s) == 8);
+    assert(_fsm.state()->_tokens == "i op:++ op:-- > - j ");
+
+    // the same bytes one by one
+    fsm::context<recorder> _bytes;
+    _bytes.enroll<recorder>();
+    _bytes.start<recorder>();
+    for (const char _c : std::string_view("i++")) handle(_bytes, _c);
+    assert(_bytes.state()->_tokens == "i + + ");
+    return 0;
+}
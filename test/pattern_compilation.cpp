@@ -0,0 +1,72 @@
+#include "pattern.hpp"
+
+#include <string>
+
+using namespace icy;
+
+int main() {
+    // [+-]? [0-9]^+ [\.[0-9]^+]? [e[+-]?[0-9]^+]?
+    const auto _float = fsm::pattern::compile("[+-]?[0-9]+(\\.[0-9]+)?(e[+-]?[0-9]+)?");
+    assert(_float.size() == 8); // AB B BCFJ D DEFJ GH H HIJ
+    assert(_float.classes() == 5);
+    auto parse_float = [&](const std::string& _s, const std::string& _expect) -> bool {
+        const auto _r = _float.match(_s);
+        if (_r.accepted) return _expect == _s.substr(0, _r.length);
+        return _expect.empty();
+    };
+    assert(parse_float("1", "1"));
+    assert(parse_float("-0.23", "-0.23"));
+    assert(parse_float("1e9", "1e9"));
+    assert(parse_float("-0.123e2.13", "-0.123e2"));
+    assert(parse_float("+0.1.123e2.13", "+0.1"));
+    assert(parse_float("+10.1e.123e2.13", ""));
+    assert(parse_float("+10e.123e2.13", ""));
+    assert(parse_float("-2.3e-3", "-2.3e-3"));
+    assert(parse_float("-2e+33e-3", "-2e+33"));
+
+    const auto _identifier = fsm::pattern::compile("[a-zA-Z_]\\w*");
+    assert(_identifier.size() == 2);
+    assert(_identifier.match("_foo42+").length == 6);
+    assert(!_identifier.match("4foo").accepted);
+
+    const auto _keyword = fsm::pattern::compile("if|else|el(if)?");
+    assert(_keyword.match("if").accepted && _keyword.match("else").accepted);
+    assert(_keyword.match("elif").accepted && _keyword.match("el").accepted);
+    assert(!_keyword.match("els").accepted);
+
+    const auto _comment = fsm::pattern::compile("/\\*([^*]|\\*+[^*/])*\\*+/");
+    assert(_comment.match("/* a * b **/").accepted);
+    assert(_comment.match("/* a */ b */").length == 7);
+
+    const auto _any = fsm::pattern::compile("a.*");
+    assert(_any.match(std::string("a\0\xff", 3)).length == 3);
+
+    const auto _empty = fsm::pattern::compile("");
+    assert(_empty.match("abc").accepted && _empty.match("abc").length == 0);
+
+    const auto _brackets = fsm::pattern::compile("[]a-]+");
+    assert(_brackets.match("]-a]b").length == 4);
+
+    // multibyte characters as a whole, \u for any multibyte character
+    const auto _accent = fsm::pattern::compile("caf\xc3\xa9+");
+    assert(_accent.match("caf\xc3\xa9\xc3\xa9!").length == 7);
+    assert(!_accent.match("caf\xc3\xa9\xc3").accepted);
+    const auto _word = fsm::pattern::compile("(\\w|\\u)+");
+    assert(_word.match("na\xc3\xafve \xe4\xb8\xad").length == 6);
+    assert(_word.match("\xe4\xb8\xad\xe6\x96\x87\xf0\x9f\x98\x80.").length == 10);
+    assert(!_word.match("a\xed\xa0\x80").accepted); // surrogate
+    assert(_word.match("a\xc0\xaf").length == 1); // overlong
+    assert(!_word.match("a\xf4\x90\x80\x80").accepted); // > U+10FFFF
+
+    for (const std::string_view _bad : {"(ab", "ab)", "*a", "a|+", "[a-", "[z-a]", "a\\"}) {
+        bool _thrown = false;
+        try {
+            fsm::pattern::compile(_bad);
+        }
+        catch (const fsm::pattern::pattern_error&) {
+            _thrown = true;
+        }
+        assert(_thrown);
+    }
+    return 0;
+}
@@ -0,0 +1,55 @@
+#include "state_layout.hpp"
+
+using namespace icy;
+
+auto session_state::handle(const frame& _e) -> label_type {
+    if (_length + _e._len > _config->_max_length) return state::label();
+    _length += _e._len;
+    ++_frames;
+    _debug->append("f");
+    return streaming::label();
+}
+auto session_state::handle(const hangup& _e) -> label_type {
+    _debug->append("c");
+    return closed::label();
+}
+auto session_state::assign(const state& _s) -> void {
+    this->operator=(dynamic_cast<const session_state&>(_s));
+}
+
+int main() {
+    using context = fsm::context<session_state>;
+    context _fsm;
+    _fsm.enroll<opening, streaming, closed>();
+    _fsm.default_entry<opening>();
+    _fsm.start();
+
+    // all state objects in one block
+    const auto _r = _fsm.layout();
+    assert(_r.states == 3);
+    assert(_r.state_bytes == sizeof(opening) + sizeof(streaming) + sizeof(closed));
+    assert(_r.span_bytes >= _r.state_bytes && _r.span_bytes <= _r.state_bytes + 3 * context::cache_line);
+    assert(_r.state_lines <= _r.span_bytes / context::cache_line + 2);
+    assert(_r.handle_lines >= 1 && _r.handle_lines <= 2);
+    assert(_r.context_bytes > sizeof(context));
+    // cold members do not grow the state objects
+    assert(sizeof(session_state) <= sizeof(fsm::state) + 2 * sizeof(size_t) + 2 * sizeof(void*));
+
+    assert(_fsm.handle(frame(100)));
+    assert(_fsm.handle(frame(200)));
+    assert(_fsm.state()->_length == 300 && _fsm.state()->_frames == 2);
+    assert(*_fsm.state()->_debug == "ff");
+    // cold members are deep copied
+    {
+        auto _child = _fsm.fork();
+        assert(_child.handle(hangup()));
+        assert(*_child.state()->_debug == "ffc");
+        assert(*_fsm.state()->_debug == "ff");
+    }
+    assert(!_fsm.handle(frame(1000)));
+    assert(_fsm.state()->_config->_peer == "localhost");
+    _fsm.restart();
+    assert(_fsm.state()->_length == 0 && _fsm.state()->_debug->empty());
+    assert(_fsm.layout().span_bytes == _r.span_bytes);
+    return 0;
+}
@@ -0,0 +1,50 @@
+#ifndef _ICY_FINITE_STATE_MACHINE_TEST_STATE_LAYOUT_HPP_
+#define _ICY_FINITE_STATE_MACHINE_TEST_STATE_LAYOUT_HPP_
+
+#include "finite_state_machine.hpp"
+
+#include <string>
+
+struct frame : public icy::fsm::event {
+    frame(size_t _len) : _len(_len) {}
+    size_t _len;
+};
+struct hangup : public icy::fsm::event {};
+
+struct session_config {
+    size_t _max_length = 1024;
+    std::string _peer = "localhost";
+};
+
+/**
+ * @details opening --frame--> streaming --hangup--> closed
+ */
+struct session_state : public icy::fsm::state {
+    using state = icy::fsm::state;
+    session_state& operator=(const session_state&) = default;
+    virtual label_type handle(const icy::fsm::event&) override { return state::label(); }
+    virtual label_type handle(const frame&);
+    virtual label_type handle(const hangup&);
+    label_type transit() override { return {}; }
+    void assign(const state&) override;
+    void reset() override { _length = 0; _frames = 0; *_debug = ""; }
+    // hot
+    size_t _length = 0;
+    size_t _frames = 0;
+    // cold
+    icy::fsm::cold<session_config> _config;
+    icy::fsm::cold<std::string> _debug;
+};
+
+struct opening : public session_state {
+    FSM_STATE_LABEL
+};
+struct streaming : public session_state {
+    FSM_STATE_LABEL
+};
+struct closed : public session_state {
+    FSM_STATE_LABEL
+    label_type handle(const frame&) override { return state::label(); }
+};
+
+#endif // _ICY_FINITE_STATE_MACHINE_TEST_STATE_LAYOUT_HPP_
@@ -0,0 +1,96 @@
+#include "state_observer.hpp"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace icy;
+
+struct tick : public fsm::event {};
+
+/**
+ * @details even --tick--> odd --tick--> even
+ */
+struct parity_state : public fsm::state {
+    using state = fsm::state;
+    parity_state& operator=(const parity_state&) = default;
+    label_type handle(const fsm::event&) override { return state::label(); }
+    virtual label_type handle(const tick&) = 0;
+    label_type transit() override { return {}; }
+    void assign(const state& _s) override { this->operator=(dynamic_cast<const parity_state&>(_s)); }
+    void reset() override { _n = 0; }
+    std::uint64_t _n = 0;
+};
+struct odd;
+struct even : public parity_state {
+    FSM_STATE_LABEL
+    label_type handle(const tick&) override;
+};
+struct odd : public parity_state {
+    FSM_STATE_LABEL
+    label_type handle(const tick&) override { ++_n; return even::label(); }
+};
+auto even::handle(const tick&) -> label_type { ++_n; return odd::label(); }
+
+/**
+ * @brief 数据摘要：四个字都等于 _n，读到撕裂的数据时不相等
+ */
+struct summary {
+    std::uint64_t _a, _b, _c, _d;
+};
+
+int main() {
+    fsm::context<parity_state> _fsm;
+    _fsm.enroll<even, odd>();
+    _fsm.accept<even>();
+    fsm::state_observer<parity_state, summary> _observer([](const parity_state& _s) {
+        return summary{_s._n, _s._n, _s._n, _s._n};
+    });
+    assert(_observer.load().label.empty());
+    _fsm.observe(&_observer);
+    assert(_observer.load().updates == 1 && _observer.load().label.empty()); // not started
+    _fsm.start<even>();
+    assert(_observer.load().label == even::label() && _observer.load().acceptable);
+
+    constexpr std::uint64_t _ticks = 200000;
+    std::atomic<bool> _done = false;
+    std::atomic<size_t> _reads = 0;
+    std::vector<std::thread> _readers;
+    for (size_t _r = 0; _r != 3; ++_r) {
+        _readers.emplace_back([&]() {
+            std::uint64_t _last = 0;
+            while (!_done.load(std::memory_order_acquire)) {
+                const auto _s = _observer.load();
+                const summary& _d = _s.data;
+                assert(_d._a == _d._b && _d._b == _d._c && _d._c == _d._d);
+                assert(_d._a >= _last); // published in order
+                assert(_s.label == (_d._a % 2 == 0 ? even::label() : odd::label()));
+                assert(_s.acceptable == (_d._a % 2 == 0));
+                _last = _d._a;
+                _reads.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+    for (std::uint64_t _i = 0; _i != _ticks; ++_i) {
+        assert(_fsm.handle(tick()));
+    }
+    _done.store(true, std::memory_order_release);
+    for (auto& _t : _readers) _t.join();
+    assert(_reads.load() > 0);
+    const auto _s = _observer.load();
+    assert(_s.data._a == _ticks && _s.label == even::label() && _s.updates == _ticks + 2);
+
+    // forks publish through their origin when committed
+    auto _fork = _fsm.fork();
+    _fork.handle(tick());
+    assert(_observer.load().data._a == _ticks);
+    _fork.commit();
+    assert(_observer.load().data._a == _ticks + 1 && _observer.load().label == odd::label());
+
+    _fsm.stop();
+    assert(_observer.load().label.empty() && !_observer.load().acceptable);
+    fsm::snapshot<summary> _v;
+    assert(_observer.try_load(_v) && _v.updates == _ticks + 4);
+    _fsm.observe(nullptr);
+    return 0;
+}
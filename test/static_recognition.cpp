@@ -0,0 +1,78 @@
+#include "static_automaton.hpp"
+
+#include <string_view>
+
+using namespace icy;
+
+struct float_machine {
+    static constexpr std::string_view pattern = "[+-]?[0-9]+(\\.[0-9]+)?(e[+-]?[0-9]+)?";
+};
+struct identifier_machine {
+    static constexpr std::string_view pattern = "[a-zA-Z_]\\w*";
+};
+struct blank_machine {
+    static constexpr std::string_view pattern = "[ \\t]*";
+};
+struct comment_machine {
+    static constexpr std::string_view pattern = "#.*";
+};
+
+static_assert(fsm::static_machine<float_machine>.states == 8);
+static_assert(fsm::static_machine<float_machine>.classes == 5);
+static_assert(fsm::recognize<float_machine>("-2.3e-3"));
+static_assert(fsm::recognize<float_machine>("1e9"));
+static_assert(!fsm::recognize<float_machine>("+10.1e"));
+static_assert(!fsm::recognize<float_machine>("-0.123e2.13"));
+static_assert(fsm::match<float_machine>("-0.123e2.13").length == 8);
+static_assert(!fsm::match<float_machine>("+10e.1").accepted);
+static_assert(fsm::recognize<identifier_machine>("_foo42"));
+static_assert(!fsm::recognize<identifier_machine>("4foo"));
+static_assert(fsm::match<comment_machine>("# anything here").length == 15); // absorbing
+
+/**
+ * @brief 配置行 <tt>name = number # comment</tt> 的编译期切分
+ */
+struct setting {
+    std::string_view name;
+    std::string_view value;
+    bool valid = false;
+};
+constexpr setting parse_setting(std::string_view _s) {
+    setting _r;
+    auto _take = [&]<typename _Mt>(_Mt) {
+        const auto _m = fsm::match<_Mt>(_s);
+        const std::string_view _t = _m.accepted ? _s.substr(0, _m.length) : std::string_view();
+        _s.remove_prefix(_t.size());
+        return _t;
+    };
+    _take(blank_machine{});
+    _r.name = _take(identifier_machine{});
+    _take(blank_machine{});
+    if (_r.name.empty() || !_s.starts_with('=')) return _r;
+    _s.remove_prefix(1);
+    _take(blank_machine{});
+    _r.value = _take(float_machine{});
+    _take(blank_machine{});
+    _take(comment_machine{});
+    _r.valid = !_r.value.empty() && _s.empty();
+    return _r;
+}
+
+constexpr setting _timeout = parse_setting("  timeout = 2.5e3   # milliseconds");
+static_assert(_timeout.valid && _timeout.name == "timeout" && _timeout.value == "2.5e3");
+static_assert(parse_setting("retries=3").value == "3");
+static_assert(!parse_setting("retries = three").valid);
+static_assert(!parse_setting("= 3").valid);
+
+int main() {
+    // the same machine at run time, agreeing with pattern::compile
+    const auto _float = fsm::pattern::compile(float_machine::pattern);
+    for (const std::string_view _s : {"1", "-0.23", "1e9", "-0.123e2.13", "+0.1.123e2.13", "+10.1e.123e2.13", "", "e", "-2e+33e-3"}) {
+        const auto _a = _float.match(_s);
+        const auto _b = fsm::static_machine<float_machine>.match(_s);
+        assert(_a.accepted == _b.accepted && _a.length == _b.length);
+    }
+    volatile bool _v = fsm::recognize<float_machine>("-2.3e-3");
+    assert(_v);
+    return 0;
+}
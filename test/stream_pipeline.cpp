@@ -0,0 +1,149 @@
+#include "stream_pipeline.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#include <unistd.h>
+
+using namespace icy;
+
+/**
+ * @brief 统计字符
+ */
+struct counter : public fsm::state {
+    FSM_STATE_LABEL
+    using state = fsm::state;
+    label_type handle(const fsm::event&) override { return state::label(); }
+    virtual label_type handle(const fsm::character::ascii_code& _e) { ++_ascii; return {}; }
+    virtual label_type handle(const fsm::character::unicode_code& _e) { ++_unicode; _sum += _e.value(); return {}; }
+    virtual label_type handle(const fsm::character::invalid_code& _e) { ++_invalid; return {}; }
+    virtual label_type handle(const fsm::character::semicolon& _e) { return state::label(); }
+    label_type transit() override { return {}; }
+    size_t _ascii = 0;
+    size_t _unicode = 0;
+    size_t _invalid = 0;
+    size_t _sum = 0;
+};
+
+void start(fsm::context<counter>& _fsm) {
+    _fsm.enroll<counter>();
+    _fsm.start<counter>();
+}
+bool same(const fsm::context<counter>& _a, const fsm::context<counter>& _b) {
+    const counter* const _x = _a.state();
+    const counter* const _y = _b.state();
+    return _x->_ascii == _y->_ascii && _x->_unicode == _y->_unicode && _x->_invalid == _y->_invalid && _x->_sum == _y->_sum;
+}
+
+int main() {
+    fsm::spsc_ring<int, 4> _ring;
+    int _x;
+    assert(!_ring.try_pop(_x));
+    for (int _i = 0; _i != 4; ++_i) assert(_ring.try_push(_i));
+    assert(!_ring.try_push(4));
+    assert(_ring.try_pop(_x) && _x == 0 && _ring.try_push(4));
+    // blocking push and pop across threads
+    std::thread _consumer([&]() {
+        for (int _i = 1, _y; _i != 1000; ++_i) {
+            _ring.pop(_y);
+            assert(_y == _i);
+        }
+    });
+    for (int _i = 5; _i != 1000; ++_i) _ring.push(_i);
+    _consumer.join();
+    assert(!_ring.try_pop(_x));
+
+    std::string _text;
+    for (size_t _i = 0; _i != 5000; ++_i) {
+        _text += "x=1.5e3, 温度 " + std::to_string(_i) + " ≥ 0 \xf0\x9f\x98\x80";
+        if (_i % 97 == 0) _text += "\xe2\x82"; // truncated sequence
+        if (_i % 89 == 0) _text += "\xc3";
+    }
+    fsm::context<counter> _serial;
+    start(_serial);
+    assert(fsm::character::handle(_serial, _text) == _text.size());
+    assert(_serial.state()->_invalid != 0);
+
+    // through a pipe, with small chunks splitting many sequences
+    int _pipe[2];
+    assert(pipe(_pipe) == 0);
+    std::thread _writer([&]() {
+        for (size_t _i = 0; _i < _text.size(); _i += 1000) {
+            const std::string_view _s = std::string_view(_text).substr(_i, 1000);
+            assert(write(_pipe[1], _s.data(), _s.size()) == static_cast<ssize_t>(_s.size()));
+        }
+        close(_pipe[1]);
+    });
+    fsm::context<counter> _piped;
+    start(_piped);
+    fsm::character::feeder<counter> _feeder(_piped);
+    fsm::stream_pipeline<61, 4> _pipeline;
+    const auto _r = _pipeline.run(_pipe[0], [&](std::string_view _s) { return _feeder.feed(_s); });
+    _writer.join();
+    close(_pipe[0]);
+    assert(_feeder.finish());
+    assert(_r.error == 0 && !_r.stopped);
+    assert(_r.reader.bytes == _text.size() && _r.parser.bytes == _text.size() && _r.parser.chunks >= _text.size() / 61);
+    assert(same(_serial, _piped));
+    assert(_r.parser.utilisation() >= 0 && _r.parser.utilisation() <= 1 && _r.throughput() > 0);
+
+    // a regular file, stopped by the parser
+    FILE* const _file = tmpfile();
+    assert(fwrite(_text.data(), 1, _text.size(), _file) == _text.size() && fflush(_file) == 0);
+    rewind(_file);
+    fsm::stream_pipeline<4096, 2> _small;
+    fsm::context<counter> _partial;
+    start(_partial);
+    fsm::character::feeder<counter> _stopper(_partial);
+    const auto _s = _small.run(fileno(_file), [&](std::string_view _c) { return _stopper.feed(_c) && _partial.state()->_ascii < 10000; });
+    assert(_s.stopped && _s.parser.bytes < _text.size());
+    rewind(_file);
+    fsm::context<counter> _whole;
+    start(_whole);
+    fsm::character::feeder<counter> _whole_feeder(_whole);
+    const auto _w = _small.run(fileno(_file), [&](std::string_view _c) { return _whole_feeder.feed(_c); });
+    assert(_whole_feeder.finish() && !_w.stopped && same(_serial, _whole));
+    fclose(_file);
+
+    // a parse error stops the pipeline
+    fsm::context<counter> _failing;
+    start(_failing);
+    fsm::character::feeder<counter> _failing_feeder(_failing);
+    FILE* const _bad = tmpfile();
+    fputs("abc;def", _bad);
+    fflush(_bad);
+    rewind(_bad);
+    assert(_small.run(fileno(_bad), [&](std::string_view _c) { return _failing_feeder.feed(_c); }).stopped);
+    fclose(_bad);
+
+    // a pipe that stays open with no further writes: the stop interrupts the reader waiting for data
+    assert(pipe(_pipe) == 0);
+    std::atomic<bool> _stopped = false, _returned = false, _rescued = false;
+    std::thread _slow_writer([&]() {
+        assert(write(_pipe[1], "abc;", 4) == 4);
+        while (!_stopped.load()) std::this_thread::yield();
+        const auto _deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (!_returned.load() && std::chrono::steady_clock::now() < _deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        _rescued = !_returned.load();
+        close(_pipe[1]);
+    });
+    fsm::context<counter> _open;
+    start(_open);
+    fsm::character::feeder<counter> _open_feeder(_open);
+    fsm::stream_pipeline<4096, 8> _deep; // free buffers left after the stop
+    const auto _o = _deep.run(_pipe[0], [&](std::string_view _c) {
+        const bool _go = _open_feeder.feed(_c);
+        _stopped = !_go;
+        return _go;
+    });
+    _returned = true;
+    _slow_writer.join();
+    close(_pipe[0]);
+    assert(_o.stopped && !_rescued); // not unblocked by closing the pipe
+    return 0;
+}
@@ -0,0 +1,154 @@
+#include "congestion_control.hpp"
+
+#include <cstdint>
+
+using namespace icy;
+
+fsm::tracked<std::uint32_t> timeouts = 0; // outside the machine, written by handlers
+
+/**
+ * @brief 会拒绝事件的状态
+ * @details transit 拒绝使窗口超过 limit 的事件；throwing 时 rto 的处理函数在写入之后抛出 state_error。
+ * rto 的处理函数还驱动 bystander（另一个非事务模式的状态机）
+ */
+template <typename _St> struct guarded : public _St {
+    using typename _St::label_type;
+    using _St::handle;
+    label_type handle(const rto& _e) override {
+        const label_type _ns = _St::handle(_e);
+        ++timeouts;
+        if (bystander != nullptr) bystander->handle(dup_ack());
+        if (throwing) throw fsm::state_error("spurious timeout");
+        return _ns;
+    }
+    label_type transit() override {
+        if (this->_cwnd > limit) { // a burst of acks must not open the window past the limit
+            ++_rejections;
+            return fsm::state::label();
+        }
+        return _St::transit();
+    }
+    std::uint32_t _rejections = 0; // not tracked
+    inline static std::uint32_t limit = 20;
+    inline static bool throwing = false;
+    inline static fsm::context<congestion_state>* bystander = nullptr;
+};
+
+void start_guarded(fsm::context<congestion_state>& _fsm) {
+    _fsm.enroll<guarded<slow_start>, guarded<avoidance>, guarded<recovery>>();
+    _fsm.default_entry<guarded<slow_start>>();
+    _fsm.start();
+}
+
+struct window {
+    std::uint32_t _cwnd, _ssthresh, _dup_acks;
+    bool operator==(const window&) const = default;
+};
+window of(const fsm::context<congestion_state>& _fsm) {
+    const congestion_state& _s = *_fsm.state();
+    return {_s._cwnd, _s._ssthresh, _s._dup_acks};
+}
+
+template <typename _Et> bool rejected(fsm::context<congestion_state>& _fsm, const _Et& _e) {
+    try {
+        return !_fsm.handle(_e);
+    }
+    catch (const fsm::state_error&) {
+        return true;
+    }
+}
+
+int main() {
+    // undo log
+    {
+        fsm::tracked<std::uint64_t> _a = 1;
+        fsm::tracked<double> _b = 2.5;
+        _a = 7; // no active log
+        assert(fsm::undo_log::current() == nullptr);
+        fsm::undo_log _log;
+        {
+            const fsm::undo_log::scope _scope(_log);
+            assert(fsm::undo_log::current() == &_log);
+            _a += 3;
+            ++_a;
+            _b *= 2;
+            const fsm::tracked<double> _c = _b; // copies are not logged
+            assert(_c == 5.0);
+            assert(_log.size() == 3);
+            fsm::undo_log _inner;
+            {
+                const fsm::undo_log::scope _nested(_inner);
+                _a = 100;
+                _inner.rollback();
+            }
+            assert(fsm::undo_log::current() == &_log && _a == 11);
+        }
+        assert(fsm::undo_log::current() == nullptr);
+        assert(_a == 11 && _b == 5.0);
+        _log.rollback();
+        assert(_a == 7 && _b == 2.5 && _log.size() == 0);
+        // a filtered log records only the writes it owns
+        fsm::undo_log _only_a(&_a, [](const void* _o, const void* _p) { return _o == _p; });
+        {
+            const fsm::undo_log::scope _scope(_only_a);
+            _a = 8;
+            _b = 3.5;
+        }
+        assert(_only_a.size() == 1);
+        _only_a.rollback();
+        assert(_a == 7 && _b == 3.5);
+    }
+
+    // rejected events roll back, accepted events commit
+    fsm::context<congestion_state> _fsm;
+    start_guarded(_fsm);
+    _fsm.transactional(true);
+    for (size_t _i = 0; _i != 10; ++_i) {
+        assert(_fsm.handle(ack()));
+    }
+    assert(_fsm.label() == slow_start::label());
+    const window _before = of(_fsm);
+    assert((_before == window{11, 64, 0}));
+    assert(rejected(_fsm, ack(1460 * 10))); // rejected by transit
+    assert(of(_fsm) == _before && _fsm.label() == slow_start::label());
+    assert(dynamic_cast<const guarded<slow_start>&>(*_fsm.state())._rejections == 1); // untracked data is kept
+
+    // only the machine's own states are restored
+    fsm::context<congestion_state> _bystander;
+    start(_bystander);
+    guarded<slow_start>::bystander = &_bystander;
+    guarded<slow_start>::throwing = true;
+    assert(rejected(_fsm, rto())); // rejected by throwing
+    assert(of(_fsm) == _before && _fsm.label() == slow_start::label());
+    assert(timeouts == 1 && _bystander.state()->_dup_acks == 1);
+    guarded<slow_start>::bystander = nullptr;
+
+    assert(_fsm.handle(dup_ack()) && _fsm.handle(dup_ack()));
+    const window _dup = of(_fsm);
+    assert(_dup._dup_acks == 2);
+    assert(rejected(_fsm, rto()));
+    assert(of(_fsm) == _dup);
+    assert(_fsm.handle(dup_ack()));
+    assert(_fsm.label() == recovery::label());
+    assert((of(_fsm) == window{8, 5, 0}));
+    assert(_fsm.handle(ack()));
+    assert(_fsm.label() == avoidance::label() && of(_fsm)._cwnd == 5);
+
+    // without transactions the rejected writes stay
+    _fsm.transactional(false);
+    guarded<avoidance>::throwing = true;
+    assert(rejected(_fsm, rto()));
+    assert((of(_fsm) == window{1, 2, 0}) && timeouts == 3);
+
+    // forks inherit the mode
+    fsm::context<congestion_state> _other;
+    start_guarded(_other);
+    _other.transactional(true);
+    auto _fork = _other.fork();
+    assert(_fork.handle(ack(2920)));
+    assert(rejected(_fork, rto()));
+    assert((of(_fork) == window{3, 64, 0}));
+    _fork.commit();
+    assert((of(_other) == window{3, 64, 0}));
+    return 0;
+}
@@ -0,0 +1,61 @@
+#include "utf8_character.hpp"
+
+#include <string>
+
+using namespace icy;
+
+auto text_state::handle(const fsm::character::printable_code& _e) -> label_type {
+    ++_characters;
+    if (_e.value() == ' ') return blank::label();
+    if (dynamic_cast<const blank*>(this) != nullptr) ++_words;
+    return word::label();
+}
+auto text_state::handle(const fsm::character::control_code& _e) -> label_type {
+    ++_characters;
+    return blank::label();
+}
+auto text_state::handle(const fsm::character::unicode_code& _e) -> label_type {
+    ++_characters;
+    ++_unicode;
+    if (dynamic_cast<const blank*>(this) != nullptr) ++_words;
+    return word::label();
+}
+auto text_state::handle(const fsm::character::unicode_space& _e) -> label_type {
+    ++_characters;
+    ++_unicode;
+    return blank::label();
+}
+auto text_state::assign(const state& _s) -> void {
+    this->operator=(dynamic_cast<const text_state&>(_s));
+}
+
+int main() {
+    using namespace fsm::character;
+    static_assert(decode("\xe4\xb8\xad").valid && decode("\xe4\xb8\xad").code == 0x4e2d);
+    static_assert(decode("\xf0\x9f\x98\x80").code == 0x1f600 && decode("\xf0\x9f\x98\x80").length == 4);
+    static_assert(!decode("\xe4\xb8").valid && decode("\xe4\xb8").length == 2);
+    static_assert(!decode("\xe0\x80\x80").valid && decode("\xe0\x80\x80").length == 1); // overlong
+    static_assert(!decode("\xc1\xbf").valid && !decode("\x80").valid && !decode("\xf5\x80").valid);
+    assert(ascii_prefix("") == 0);
+    assert(ascii_prefix("0123456789abcdefghijklmnopqrstuvwxyz") == 36);
+    assert(ascii_prefix("0123456789abcdefghij\xc3\xa9") == 20);
+    assert(ascii_prefix("\xc3\xa9") == 0);
+
+    fsm::context<text_state> _fsm;
+    _fsm.enroll<word, blank>();
+    _fsm.default_entry<blank>();
+    _fsm.start();
+    // 'café naïve　中文 plain ascii words follow here'
+    const std::string _text = "caf\xc3\xa9 na\xc3\xafve\xe3\x80\x80\xe4\xb8\xad\xe6\x96\x87 plain ascii words follow here";
+    assert(handle(_fsm, _text) == _text.size());
+    assert(_fsm.state()->_words == 8);
+    assert(_fsm.state()->_characters == 43);
+    assert(_fsm.state()->_unicode == 5);
+
+    // invalid sequences are reported once per maximal subpart, and not handled by text_state
+    _fsm.restart();
+    assert(handle(_fsm, std::string_view("ok \xe4\xb8 more")) == 3);
+    _fsm.restart();
+    assert(handle(_fsm, std::string_view("\xe4\xb8\xad\x80")) == 3);
+    return 0;
+}
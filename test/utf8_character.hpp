@@ -0,0 +1,32 @@
+#ifndef _ICY_FINITE_STATE_MACHINE_TEST_UTF8_CHARACTER_HPP_
+#define _ICY_FINITE_STATE_MACHINE_TEST_UTF8_CHARACTER_HPP_
+
+#include "finite_state_machine.hpp"
+
+/**
+ * @details word --space--> blank --other--> word, counting words and characters
+ */
+struct text_state : public icy::fsm::state {
+    using state = icy::fsm::state;
+    text_state& operator=(const text_state&) = default;
+    virtual label_type handle(const icy::fsm::event&) override { return state::label(); }
+    virtual label_type handle(const icy::fsm::character::printable_code&);
+    virtual label_type handle(const icy::fsm::character::control_code&);
+    virtual label_type handle(const icy::fsm::character::unicode_code&);
+    virtual label_type handle(const icy::fsm::character::unicode_space&);
+    label_type transit() override { return {}; }
+    void assign(const state&) override;
+    void reset() override { _words = 0; _characters = 0; _unicode = 0; }
+    size_t _words = 0;
+    size_t _characters = 0;
+    size_t _unicode = 0;
+};
+
+struct word : public text_state {
+    FSM_STATE_LABEL
+};
+struct blank : public text_state {
+    FSM_STATE_LABEL
+};
+
+#endif // _ICY_FINITE_STATE_MACHINE_TEST_UTF8_CHARACTER_HPP_
@@ -0,0 +1,32 @@
+#include "code_generator.hpp"
+#include "pattern.hpp"
+
+#include <cstdio>
+#include <fstream>
+
+using namespace icy;
+
+/**
+ * @brief usage: fsm_generate <name> <pattern> <output>
+ */
+int main(int _argc, char* _argv[]) {
+    if (_argc != 4) {
+        fprintf(stderr, "usage: %s <name> <pattern> <output>\n", _argv[0]);
+        return 1;
+    }
+    fsm::dfa _d;
+    try {
+        _d = fsm::pattern::compile(_argv[2]);
+    }
+    catch (const fsm::pattern::pattern_error& _e) {
+        fprintf(stderr, "%s: %s\n", _argv[2], _e.what());
+        return 1;
+    }
+    std::ofstream _os(_argv[3]);
+    if (!_os) {
+        fprintf(stderr, "can not open %s\n", _argv[3]);
+        return 1;
+    }
+    fsm::generate(_os, _d, _argv[1]);
+    return _os ? 0 : 1;
+}